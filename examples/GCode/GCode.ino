@@ -0,0 +1,56 @@
+/*
+ * Streaming G-code example
+ *
+ * Reads G-code from the serial port and runs it on a two-axis SyncDriver group.
+ * Supported: G0, G1 (X, Y, Z, F), G4 (P ms or S s), G90, G91, G92.
+ * The next lines are parsed while the current move is running.
+ *
+ * Copyright (C)2026 Laurentiu Badea
+ *
+ * This file may be redistributed under the terms of the MIT license.
+ * A copy of this license has been included with this distribution in the file LICENSE.
+ */
+#include <Arduino.h>
+#include "BasicStepperDriver.h"
+#include "SyncDriver.h"
+#include "GCodeInterpreter.h"
+
+// Motor steps per revolution. Most steppers are 200 steps or 1.8 degrees/step
+#define MOTOR_STEPS 200
+// If microstepping is set externally, make sure this matches the selected mode
+#define MICROSTEPS 16
+// Steps per mm: 200 steps * 16 microsteps / 40mm per revolution (20-tooth GT2 pulley)
+#define STEPS_PER_MM 80
+// Motor RPM used for G0 moves
+#define RAPID_RPM 300
+
+// X motor
+#define DIR_X 8
+#define STEP_X 9
+
+// Y motor
+#define DIR_Y 6
+#define STEP_Y 7
+
+BasicStepperDriver stepperX(MOTOR_STEPS, DIR_X, STEP_X);
+BasicStepperDriver stepperY(MOTOR_STEPS, DIR_Y, STEP_Y);
+SyncDriver controller(stepperX, stepperY);
+GCodeInterpreter gcode(controller);
+
+void setup() {
+    Serial.begin(115200);
+    controller.begin(RAPID_RPM, MICROSTEPS);
+    stepperX.setSpeedProfile(stepperX.LINEAR_SPEED, 2000, 2000);
+    stepperY.setSpeedProfile(stepperY.LINEAR_SPEED, 2000, 2000);
+
+    gcode.setStepsPerUnit(STEPS_PER_MM, STEPS_PER_MM);
+    gcode.setRapidRPM(RAPID_RPM);
+    Serial.println("READY");
+}
+
+void loop() {
+    // parse as much input as the move queue has room for
+    gcode.process(Serial);
+    // step the current move, start the next one when it completes
+    gcode.service(micros());
+}
@@ -0,0 +1,71 @@
+/*
+ * Homing example
+ *
+ * Homes two axes at the same time against limit switches wired between the
+ * switch pins and GND, then moves to a position relative to home.
+ * Use interrupt capable pins for the switches (2 and 3 on Uno) so a switch is
+ * caught before the next step even at high speed.
+ *
+ * Copyright (C)2026 Laurentiu Badea
+ *
+ * This file may be redistributed under the terms of the MIT license.
+ * A copy of this license has been included with this distribution in the file LICENSE.
+ */
+#include <Arduino.h>
+#include "BasicStepperDriver.h"
+#include "MultiDriver.h"
+#include "Homing.h"
+
+// Motor steps per revolution. Most steppers are 200 steps or 1.8 degrees/step
+#define MOTOR_STEPS 200
+// If microstepping is set externally, make sure this matches the selected mode
+#define MICROSTEPS 8
+
+// X motor and home switch
+#define DIR_X 8
+#define STEP_X 9
+#define HOME_X 2
+
+// Y motor and home switch
+#define DIR_Y 6
+#define STEP_Y 7
+#define HOME_Y 3
+
+BasicStepperDriver stepperX(MOTOR_STEPS, DIR_X, STEP_X);
+BasicStepperDriver stepperY(MOTOR_STEPS, DIR_Y, STEP_Y);
+MultiDriver controller(stepperX, stepperY);
+
+Homing homeX(stepperX, HOME_X);
+Homing homeY(stepperY, HOME_Y);
+Homing* const axes[] = {&homeX, &homeY};
+
+void setup() {
+    Serial.begin(115200);
+    controller.begin(120, MICROSTEPS);
+    // braking distance after the switch triggers during the fast seek
+    stepperX.setSpeedProfile(stepperX.LINEAR_SPEED, 2000, 2000);
+    stepperY.setSpeedProfile(stepperY.LINEAR_SPEED, 2000, 2000);
+
+    // fast seek at 300 RPM, slow approach at 15 RPM
+    homeX.setSpeeds(300, 15);
+    homeY.setSpeeds(300, 15);
+    // back off 20 full steps, search up to 50 revolutions
+    homeX.setDistances(20 * MICROSTEPS, 50L * MOTOR_STEPS * MICROSTEPS);
+    homeY.setDistances(20 * MICROSTEPS, 50L * MOTOR_STEPS * MICROSTEPS);
+
+    if (Homing::home(axes, 2, -1)){
+        Serial.println("HOMED");
+    } else {
+        Serial.println("HOMING FAILED");
+    }
+}
+
+void loop() {
+    // go to 10 revolutions from home and back
+    controller.move(10L * MOTOR_STEPS * MICROSTEPS - stepperX.getPosition(),
+                    10L * MOTOR_STEPS * MICROSTEPS - stepperY.getPosition());
+    Serial.println(stepperX.getPosition());
+    controller.move(-stepperX.getPosition(), -stepperY.getPosition());
+    Serial.println(stepperX.getPosition());
+    delay(1000);
+}
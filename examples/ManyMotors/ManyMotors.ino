@@ -0,0 +1,86 @@
+/*
+ * Many motors example
+ *
+ * Runs eight motors from a single hardware timer with StepScheduler: the timer
+ * interrupt fires the steps that are due and is reprogrammed for the next one, so
+ * the loop is free for other work. On AVR this uses Timer1 (pins 9 and 10 lose
+ * analogWrite); on other boards the loop runs the scheduler instead.
+ *
+ * Copyright (C)2026 Laurentiu Badea
+ *
+ * This file may be redistributed under the terms of the MIT license.
+ * A copy of this license has been included with this distribution in the file LICENSE.
+ */
+#include <Arduino.h>
+#include "BasicStepperDriver.h"
+#include "StepScheduler.h"
+
+// Motor steps per revolution. Most steppers are 200 steps or 1.8 degrees/step
+#define MOTOR_STEPS 200
+#define RPM 60
+#define MICROSTEPS 1
+
+// DIR and STEP pins of each motor. Pins 22-37 are on the Arduino Mega header;
+// change them to free pins on other boards
+#define COUNT 8
+const short PINS[COUNT][2] = {
+    {22, 23}, {24, 25}, {26, 27}, {28, 29}, {30, 31}, {32, 33}, {34, 35}, {36, 37}
+};
+
+BasicStepperDriver* motors[COUNT];
+StepScheduler scheduler(motors, COUNT);
+
+#ifdef __AVR__
+// Timer1 ticks per microsecond (prescaler 8)
+#define TICKS_PER_MICRO (F_CPU / 8000000L)
+
+void schedule(unsigned long next){
+    if (!next){
+        TIMSK1 &= ~_BV(OCIE1A);
+        return;
+    }
+    // longer waits wake up early and are rescheduled by service()
+    unsigned long ticks = next * TICKS_PER_MICRO;
+    OCR1A = TCNT1 + ((ticks < 0xFFFF) ? ticks : 0xFFFF);
+    TIFR1 = _BV(OCF1A);
+    TIMSK1 |= _BV(OCIE1A);
+}
+
+ISR(TIMER1_COMPA_vect){
+    schedule(scheduler.service(micros()));
+}
+
+void startScheduler(void){
+    // normal mode, prescaler 8
+    TCCR1A = 0;
+    TCCR1B = _BV(CS11);
+    schedule(1);
+}
+#endif
+
+void setup() {
+    for (short i = 0; i < COUNT; i++){
+        motors[i] = new BasicStepperDriver(MOTOR_STEPS, PINS[i][0], PINS[i][1]);
+        motors[i]->begin(RPM + 10 * i, MICROSTEPS);
+        motors[i]->setSpeedProfile(motors[i]->LINEAR_SPEED, 500, 500);
+    }
+    // waits shorter than the interrupt entry and exit are done in service()
+    scheduler.setWindow(20);
+}
+
+void loop() {
+    // every motor turns one revolution, each at its own speed
+    for (short i = 0; i < COUNT; i++){
+        motors[i]->startMove(MOTOR_STEPS * MICROSTEPS);
+    }
+#ifdef __AVR__
+    startScheduler();
+    // the interrupt is turned off when all moves are done
+    while (TIMSK1 & _BV(OCIE1A)){
+        // free for other work
+    }
+#else
+    scheduler.run();
+#endif
+    delay(1000);
+}
@@ -92,17 +92,18 @@ void loop() {
         // stepper.startBrake();
     }
 
-    // motor control loop - send pulse and return how long to wait until next pulse
-    unsigned wait_time_micros = stepper.nextAction();
-
-    // 0 wait time indicates the motor has stopped
-    if (wait_time_micros <= 0) {
+    // motor control loop - send pulse if one is due, never waits for the next one
+    // (nextAction() is the simpler alternative: it waits for the pulse and returns
+    // how long until the next one)
+    unsigned long now = micros();
+    if (!stepper.service(now)){
+        // move is complete
         stepper.disable();       // comment out to keep motor powered
         delay(3600000);
     }
 
-    // (optional) execute other code if we have enough time
-    if (wait_time_micros > 100){
+    // (optional) execute other code if we have enough time until the next pulse
+    if (stepper.getTimeToNextAction(now) > 100){
         // other code here
     }
 }
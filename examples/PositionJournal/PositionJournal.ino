@@ -0,0 +1,92 @@
+/*
+ * Position journal example
+ *
+ * Keeps the motor position in EEPROM, so after a reset or power loss the motor
+ * continues from where it was instead of homing. It only homes on first use (blank
+ * EEPROM) or if power was lost in the middle of a move.
+ *
+ * Copyright (C)2026 Laurentiu Badea
+ *
+ * This file may be redistributed under the terms of the MIT license.
+ * A copy of this license has been included with this distribution in the file LICENSE.
+ */
+#include <Arduino.h>
+// boards with an EEPROM library; the journal header uses it when included first
+#if defined(__AVR__) || defined(ARDUINO_ARCH_ESP32) || defined(ARDUINO_ARCH_ESP8266) || defined(TEENSYDUINO)
+#include <EEPROM.h>
+#endif
+#include "BasicStepperDriver.h"
+#include "Homing.h"
+#include "PositionJournal.h"
+
+// Motor steps per revolution. Most steppers are 200 steps or 1.8 degrees/step
+#define MOTOR_STEPS 200
+#define RPM 120
+#define MICROSTEPS 1
+
+#define DIR 8
+#define STEP 9
+#define HOME_SWITCH 2
+
+// EEPROM area used by the journal, the more records fit the less each byte wears
+#define JOURNAL_START 0
+#define JOURNAL_SIZE 240
+
+BasicStepperDriver stepper(MOTOR_STEPS, DIR, STEP);
+Homing homing(stepper, HOME_SWITCH);
+#ifdef POSITION_JOURNAL_EEPROM
+EEPROMStorage storage(JOURNAL_START, JOURNAL_SIZE);
+#else
+/*
+ * No EEPROM on this board (e.g. SAMD): implement JournalStorage for its flash or an
+ * external FRAM. This stand-in keeps the journal in RAM, so it is lost at power off.
+ */
+class RAMStorage : public JournalStorage {
+protected:
+    uint8_t data[JOURNAL_SIZE];
+public:
+    unsigned size(void) override {
+        return JOURNAL_SIZE;
+    }
+    uint8_t read(unsigned address) override {
+        return data[address];
+    }
+    void write(unsigned address, uint8_t value) override {
+        data[address] = value;
+    }
+};
+RAMStorage storage;
+#endif
+PositionJournal journal(stepper, storage);
+
+void setup() {
+    Serial.begin(115200);
+#if defined(ARDUINO_ARCH_ESP32) || defined(ARDUINO_ARCH_ESP8266)
+    EEPROM.begin(JOURNAL_START + JOURNAL_SIZE);
+#endif
+    stepper.begin(RPM, MICROSTEPS);
+    stepper.setSpeedProfile(stepper.LINEAR_SPEED, 1000, 1000);
+
+    if (journal.begin() && journal.isExact()){
+        Serial.print("Restored position ");
+        Serial.println((long)stepper.getPosition());
+    } else {
+        Serial.println("Position unknown, homing");
+        if (!homing.home()){
+            Serial.println("HOMING FAILED");
+            while (true);
+        }
+        // journal the home position
+        journal.save();
+    }
+    // during long moves, also journal the position every 5 seconds
+    journal.setInterval(5000);
+}
+
+void loop() {
+    // back and forth between 1 and 3 revolutions from home
+    journal.move(3L * MOTOR_STEPS * MICROSTEPS - stepper.getPosition());
+    delay(1000);
+    journal.move(1L * MOTOR_STEPS * MICROSTEPS - stepper.getPosition());
+    delay(1000);
+}
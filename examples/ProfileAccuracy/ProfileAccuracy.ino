@@ -0,0 +1,156 @@
+/*
+ * This is not an example sketch, it is used to check the accuracy of the linear
+ * speed profile math against ideal constant acceleration kinematics.
+ *
+ * Usage: run with serial terminal open. No motor is needed, the step intervals are
+ * calculated without stepping (nextProfileStep()).
+ *
+ * For each combination of rpm, microsteps, accel/decel and move length it reports:
+ *  - interval error: the largest relative error of a step interval vs the ideal one,
+ *    and the step where it occurs (the first steps of the ramps are the hardest),
+ *    and the rms error over all steps
+ *  - time error: total move time from the step intervals vs the ideal move time
+ *  - estimate error: getTimeForMove() vs the ideal move time
+ *  - calc: average time to calculate one step interval on this board (ns)
+ * A line FAILs if the time or estimate error exceed MAX_TIME_ERROR.
+ * The sweep runs with the default approximation, then with setExactRamps().
+ *
+ * Copyright (C)2026 Laurentiu Badea
+ *
+ * This file may be redistributed under the terms of the MIT license.
+ * A copy of this license has been included with this distribution in the file LICENSE.
+ */
+#include <Arduino.h>
+
+#include "BasicStepperDriver.h"
+
+#define MOTOR_STEPS 200
+const float RPMS[] = {60, 300, 1200};
+const short MICROSTEPS[] = {1, 16};
+const short ACCELS[][2] = {{200, 200}, {1000, 3000}, {5000, 1000}};
+// move lengths in full steps
+const long MOVES[] = {20, 500};
+// allowed relative error of the total move time
+#define MAX_TIME_ERROR 0.02
+
+#define COUNT(array) (sizeof(array)/sizeof(*array))
+
+/*
+ * Ideal time (s) at which a move of <distance> microsteps reaches <position>,
+ * starting and ending at rest. Speeds in microsteps/s, accelerations in microsteps/s^2.
+ */
+float idealTime(float position, float distance, float speed, float accel, float decel){
+    float accel_distance = speed * speed / (2 * accel);
+    float decel_distance = speed * speed / (2 * decel);
+    if (accel_distance + decel_distance > distance){
+        // triangular move, never reaches the target speed
+        speed = sqrt(2 * distance / (1/accel + 1/decel));
+        accel_distance = speed * speed / (2 * accel);
+        decel_distance = distance - accel_distance;
+    }
+    if (position <= accel_distance){
+        return sqrt(2 * position / accel);
+    }
+    float cruise_end = distance - decel_distance;
+    if (position <= cruise_end){
+        return speed / accel + (position - accel_distance) / speed;
+    }
+    float cruise_time = speed / accel + (cruise_end - accel_distance) / speed;
+    float end_speed2 = speed * speed - 2 * decel * (position - cruise_end);
+    return cruise_time + (speed - sqrt((end_speed2 > 0) ? end_speed2 : 0)) / decel;
+}
+
+bool test_profile(BasicStepperDriver& stepper, bool exact, float rpm, short microsteps,
+                  short accel, short decel, long full_steps){
+    char t[128];
+    long steps = full_steps * microsteps;
+    stepper.begin(rpm, microsteps);
+    stepper.setSpeedProfile(stepper.LINEAR_SPEED, accel, decel);
+    stepper.setExactRamps(exact);
+    float speed = rpm * MOTOR_STEPS / 60 * microsteps;
+    float a = (float)accel * microsteps;
+    float d = (float)decel * microsteps;
+    float ideal_total = idealTime(steps, steps, speed, a, d);
+    long estimate = stepper.getTimeForMove(steps);
+
+    stepper.startMove(steps);
+    float time = 0;
+    float worst = 0;
+    long worst_step = 0;
+    float sum_squares = 0;
+    for (long i = 0; i < steps; i++){
+        float interval = stepper.nextProfileStep() / 1e+6;
+        float ideal = idealTime(i + 1, steps, speed, a, d) - idealTime(i, steps, speed, a, d);
+        float error = (interval - ideal) / ideal;
+        if (fabs(error) > fabs(worst)){
+            worst = error;
+            worst_step = i;
+        }
+        sum_squares += error * error;
+        time += interval;
+    }
+    float rms = sqrt(sum_squares / steps);
+
+    // profile calculation only
+    stepper.startMove(steps);
+    unsigned long start = micros();
+    while (stepper.nextProfileStep());
+    unsigned long calc_ns = (micros() - start) * 1000 / steps;
+    float time_error = (time - ideal_total) / ideal_total;
+    float estimate_error = (estimate / 1e+6 - ideal_total) / ideal_total;
+
+    sprintf(t, "  rpm=%-4d microstep=%-2d accel=%-4d decel=%-4d steps=%-6ld ideal=%9ldµs",
+            int(rpm), microsteps, accel, decel, steps, long(ideal_total * 1e+6));
+    Serial.print(t);
+    Serial.print(" interval_err=");
+    Serial.print(worst * 100, 1);
+    sprintf(t, "%% @%-5ld rms=", worst_step);
+    Serial.print(t);
+    Serial.print(rms * 100, 2);
+    Serial.print("% time_err=");
+    Serial.print(time_error * 100, 2);
+    Serial.print("% estimate_err=");
+    Serial.print(estimate_error * 100, 2);
+    sprintf(t, "%% calc=%5luns", calc_ns);
+    Serial.print(t);
+    bool pass = fabs(time_error) <= MAX_TIME_ERROR && fabs(estimate_error) <= MAX_TIME_ERROR;
+    if (!pass){
+        Serial.print(" FAIL");
+    }
+    Serial.println();
+    return pass;
+}
+
+void setup() {
+    BasicStepperDriver stepper(MOTOR_STEPS, 12, 13);
+    bool pass = true;
+
+    Serial.begin(115200);
+    delay(2000);
+#ifdef ARDUINO_BOARD
+    Serial.println(ARDUINO_BOARD);
+#endif
+    for (int exact = 0; exact <= 1; exact++){
+        Serial.println(exact ? "Linear speed profile accuracy, exact ramps"
+                             : "Linear speed profile accuracy");
+        bool mode_pass = true;
+        for (unsigned r = 0; r < COUNT(RPMS); r++){
+            for (unsigned m = 0; m < COUNT(MICROSTEPS); m++){
+                for (unsigned a = 0; a < COUNT(ACCELS); a++){
+                    for (unsigned s = 0; s < COUNT(MOVES); s++){
+                        mode_pass &= test_profile(stepper, exact, RPMS[r], MICROSTEPS[m],
+                                                  ACCELS[a][0], ACCELS[a][1], MOVES[s]);
+                    }
+                }
+            }
+        }
+        Serial.println(mode_pass ? "OK" : "FAIL");
+        pass &= mode_pass;
+    }
+    Serial.println(pass ? "OK" : "FAIL");
+    Serial.println("TESTS COMPLETE");
+}
+
+void loop() {
+    delay(1);
+}
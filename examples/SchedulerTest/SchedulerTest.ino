@@ -0,0 +1,156 @@
+/*
+ * This is not an example sketch, it is used to measure the step timing of many motors
+ * run by one StepScheduler, against the MultiDriver::nextAction() loop.
+ *
+ * Usage: run with serial terminal open. No motors are needed, all of them use the
+ * same pins.
+ *
+ * Each motor runs at a different constant speed for about one second, so the step
+ * deadlines interleave and sometimes coincide. For each run it reports:
+ *  - elapsed: time until all motors stopped, vs the longest getTimeForMove()
+ *  - late: the worst lateness of a step vs the motor's ideal schedule, as seen right
+ *    after the call that fired it
+ *  - rate: total steps per second over all motors
+ * A run FAILs if elapsed is off by more than ALLOWED_DEVIATION, which means the board
+ * cannot sustain that total step rate. test/test_step_scheduler runs the same moves
+ * on the host, with a fixed cost per pin write.
+ *
+ * Copyright (C)2026 Laurentiu Badea
+ *
+ * This file may be redistributed under the terms of the MIT license.
+ * A copy of this license has been included with this distribution in the file LICENSE.
+ */
+#include <Arduino.h>
+
+#include "BasicStepperDriver.h"
+#include "MultiDriver.h"
+#include "StepScheduler.h"
+
+#define MOTOR_STEPS 200
+#define MAX_COUNT 16
+// speed of the first motor, the others run progressively faster
+const float RPMS[] = {60, 300};
+const short COUNTS[] = {3, 8, 16};
+#define ALLOWED_DEVIATION 0.10
+
+#define COUNT(array) (sizeof(array)/sizeof(*array))
+
+BasicStepperDriver* motors[MAX_COUNT];
+
+/*
+ * Step timing check
+ */
+steps_t move_steps[MAX_COUNT];
+steps_t last_completed[MAX_COUNT];
+unsigned long first_step[MAX_COUNT];
+long pulse[MAX_COUNT];
+unsigned long worst_late;
+
+float motorRPM(float rpm, short i){
+    return rpm * (1 + i / 4.0);
+}
+
+// set up one second moves, returns the longest expected time
+long setupMoves(float rpm, short count){
+    long expected = 0;
+    for (short i = 0; i < count; i++){
+        float motor_rpm = motorRPM(rpm, i);
+        move_steps[i] = motor_rpm * MOTOR_STEPS / 60;
+        motors[i]->begin(motor_rpm, 1);
+        pulse[i] = STEP_PULSE(MOTOR_STEPS, 1, motor_rpm);
+        long time = motors[i]->getTimeForMove(move_steps[i]);
+        expected = (time > expected) ? time : expected;
+        last_completed[i] = 0;
+    }
+    worst_late = 0;
+    return expected;
+}
+
+void checkSteps(short count){
+    unsigned long now = micros();
+    for (short i = 0; i < count; i++){
+        steps_t completed = motors[i]->getStepsCompleted();
+        if (completed == last_completed[i]){
+            continue;
+        }
+        if (!last_completed[i]){
+            first_step[i] = now;
+        } else {
+            unsigned long late = now - (first_step[i] + (completed - 1) * pulse[i]);
+            if ((long)late > 0 && late > worst_late){
+                worst_late = late;
+            }
+        }
+        last_completed[i] = completed;
+    }
+}
+
+bool result(const char* method, float rpm, short count, long elapsed, long expected){
+    char t[128];
+    steps_t steps = 0;
+    for (short i = 0; i < count; i++){
+        steps += motors[i]->getStepsCompleted();
+    }
+    float error = float(elapsed) / float(expected);
+    sprintf(t, "  %-9s motors=%-2d rpm=%-4d expected=%8ldµs elapsed=%8ldµs late=%6luµs rate=%6ld/s",
+            method, count, int(rpm), expected, elapsed, worst_late, long(steps * 1e+6 / elapsed));
+    Serial.print(t);
+    bool pass = error < 1.0f + ALLOWED_DEVIATION && error > 1.0f - ALLOWED_DEVIATION;
+    if (!pass){
+        Serial.print(" FAIL");
+    }
+    Serial.println();
+    return pass;
+}
+
+bool test_multi(float rpm){
+    MultiDriver controller(*motors[0], *motors[1], *motors[2]);
+    long expected = setupMoves(rpm, 3);
+    unsigned long start = micros();
+    controller.startMove(move_steps[0], move_steps[1], move_steps[2]);
+    while (controller.nextAction()){
+        checkSteps(3);
+    }
+    return result("multi", rpm, 3, micros() - start, expected);
+}
+
+bool test_scheduler(float rpm, short count){
+    StepScheduler scheduler(motors, count);
+    long expected = setupMoves(rpm, count);
+    unsigned long start = micros();
+    for (short i = 0; i < count; i++){
+        motors[i]->startMove(move_steps[i]);
+    }
+    unsigned long next;
+    while ((next = scheduler.service(micros()))){
+        checkSteps(count);
+        BasicStepperDriver::delayMicros(next);
+    }
+    return result("scheduler", rpm, count, micros() - start, expected);
+}
+
+void setup() {
+    bool pass = true;
+
+    Serial.begin(115200);
+    delay(2000);
+#ifdef ARDUINO_BOARD
+    Serial.println(ARDUINO_BOARD);
+#endif
+    for (short i = 0; i < MAX_COUNT; i++){
+        motors[i] = new BasicStepperDriver(MOTOR_STEPS, 12, 13);
+    }
+    Serial.println("Step scheduler timing");
+    for (unsigned r = 0; r < COUNT(RPMS); r++){
+        pass &= test_multi(RPMS[r]);
+        for (unsigned c = 0; c < COUNT(COUNTS); c++){
+            pass &= test_scheduler(RPMS[r], COUNTS[c]);
+        }
+    }
+    Serial.println(pass ? "OK" : "FAIL");
+    Serial.println("TESTS COMPLETE");
+}
+
+void loop() {
+    delay(1);
+}
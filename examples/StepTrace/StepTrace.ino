@@ -0,0 +1,49 @@
+/*
+ * Step trace example
+ *
+ * Records the exact step sequence of an accelerated move and prints it on Serial
+ * when done, for comparison with extras/steptrace.py, e.g. before and after a
+ * library change, or between two boards:
+ *
+ *   extras/steptrace.py diff before.txt after.txt --tolerance 8
+ *
+ * Copyright (C)2026 Laurentiu Badea
+ *
+ * This file may be redistributed under the terms of the MIT license.
+ * A copy of this license has been included with this distribution in the file LICENSE.
+ */
+#include <Arduino.h>
+#include "BasicStepperDriver.h"
+#include "StepRecorder.h"
+
+// Motor steps per revolution. Most steppers are 200 steps or 1.8 degrees/step
+#define MOTOR_STEPS 200
+#define RPM 120
+#define MICROSTEPS 1
+
+#define DIR 8
+#define STEP 9
+
+// buffer for the whole move (3-4 bytes per step), as printing while moving
+// would change the timing
+#define STEPS 200
+StepRecorder::Event events[STEPS + 1];
+StepRecorder recorder(events, STEPS + 1);
+
+BasicStepperDriver stepper(MOTOR_STEPS, DIR, STEP);
+
+void setup() {
+    Serial.begin(115200);
+    stepper.begin(RPM, MICROSTEPS);
+    stepper.setSpeedProfile(stepper.LINEAR_SPEED, 1000, 1000);
+    stepper.setRecorder(&recorder);
+
+    stepper.move(STEPS / 2);
+    stepper.move(-STEPS / 2);
+
+    recorder.print(Serial);
+    Serial.println("TRACE END");
+}
+
+void loop() {
+}
@@ -129,6 +129,56 @@ bool test_sync(BasicStepperDriver s1, BasicStepperDriver s2, BasicStepperDriver
     return pass;
 }
 
+/*
+ * Emergency stop latency: trigger at fixed points spread over group moves, from the
+ * polling loop between steps (test/test_emergency_stop raises it from a simulated
+ * interrupt instead) and check that no motor steps again and all
+ * motors stop within one step period. Reports the worst case.
+ * The trigger points also move through the step period, so the result is repeatable
+ * but still samples different phases.
+ */
+bool test_emergency(BasicStepperDriver s1, BasicStepperDriver s2, BasicStepperDriver s3){
+    MultiDriver controller(s1, s2, s3);
+    bool pass = true;
+    char t[128];
+    const float rpm = 600;
+    long step_micros = STEP_PULSE(200, 1, rpm);
+    unsigned long worst = 0;
+    long extra_steps = 0;
+    s1.begin(rpm, 1);
+    s2.begin(rpm, 1);
+    s3.begin(rpm, 1);
+    for (int i = 0; i < 20; i++){
+        BasicStepperDriver::clearEmergencyStop();
+        controller.startMove(10*STEPS, -7*STEPS, 5*STEPS);
+        unsigned long trigger = micros() + step_micros * (1 + 49*i) + step_micros * i / 20;
+        unsigned long triggered = 0;
+        long completed = 0;
+        while (controller.service(micros())){
+            if (!triggered && (long)(micros() - trigger) >= 0){
+                triggered = micros();
+                BasicStepperDriver::emergencyStop();
+                completed = s1.getStepsCompleted() + s2.getStepsCompleted() + s3.getStepsCompleted();
+            }
+        }
+        unsigned long latency = micros() - triggered;
+        if (latency > worst){
+            worst = latency;
+        }
+        extra_steps += s1.getStepsCompleted() + s2.getStepsCompleted() + s3.getStepsCompleted() - completed;
+    }
+    BasicStepperDriver::clearEmergencyStop();
+    sprintf(t, "  rpm=%-4d step=%6ldµs worst latency=%6luµs steps after stop=%ld",
+            int(rpm), step_micros, worst, extra_steps);
+    Serial.print(t);
+    if (extra_steps || worst > (unsigned long)step_micros){
+        pass = false;
+        Serial.print(" FAIL");
+    }
+    Serial.println();
+    return pass;
+}
+
 #define TEST_RESULT(result, func, ...) #func "(" #__VA_ARGS__ "): " result
 #define RUN_TEST(desc, func, ...) Serial.println(desc); Serial.println(func(__VA_ARGS__) ? TEST_RESULT("OK", func, __VA_ARGS__) : TEST_RESULT("FAIL", func, __VA_ARGS__))
 
@@ -143,6 +193,14 @@ void setup() {
 #ifdef ARDUINO_BOARD
     Serial.println(ARDUINO_BOARD);
 #endif
+    {
+        BasicStepperDriver stepper(200, 12, 13);
+        stepper.begin(60, 1);
+        char t[64];
+        sprintf(t, "Calibrated step interval %uµs, max RPM ", stepper.calibrate());
+        Serial.print(t);
+        Serial.println(stepper.getMaxRPM());
+    }
     RUN_TEST("Timing Calculation test, constant speed", test_calculations, s1, DURATION_CONSTANT);
     RUN_TEST("BasicStepperDriver test, constant speed", test_basic, s1);
     RUN_TEST("MultiDriver test, constant speed", test_multi, s1, s2, s3);
@@ -156,6 +214,7 @@ void setup() {
     RUN_TEST("BasicStepperDriver test, linear speed", test_basic, s1);
     RUN_TEST("MultiDriver test, linear speed", test_multi, s1, s2, s3);
     RUN_TEST("SyncDriver test, linear speed", test_sync, s1, s2, s3);
+    RUN_TEST("Emergency stop test", test_emergency, s1, s2, s3);
 
     Serial.println("TESTS COMPLETE");
 }
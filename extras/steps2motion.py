@@ -0,0 +1,97 @@
+#!/usr/bin/env python3
+#
+# steps2motion.py - Convert a step list to the MotionPlayer binary segment format
+#
+# Usage:
+#   extras/steps2motion.py [input.csv] [output.bin]     (default stdin/stdout)
+#
+# Input is one segment per line, blank lines and lines starting with # are skipped:
+#   steps1,steps2[,steps3][,rpm]    relative move, rpm optional (keeps current speed)
+#   dwell,milliseconds              pause
+# A MOTION_END segment is appended at the end.
+#
+# Moves larger than a 16-bit segment are split into equal parts that all fit,
+# so the relative axis proportions are kept (up to rounding of the last part).
+#
+# See src/MotionPlayer.h for the record format.
+#
+# Copyright (C)2026 Laurentiu Badea
+#
+# This file may be redistributed under the terms of the MIT license.
+# A copy of this license has been included with this distribution in the file LICENSE.
+
+import struct
+import sys
+
+MOTION_SYNC = 0xA5
+MOTION_RPM_SCALE = 8
+MOTION_DWELL = 0x01
+MOTION_END = 0x02
+STEPS_MAX = 32767
+
+
+def crc8(data):
+    crc = 0
+    for b in data:
+        crc ^= b
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x07) & 0xff if crc & 0x80 else (crc << 1) & 0xff
+    return crc
+
+
+def record(steps, rpm=0, flags=0):
+    data = struct.pack("<BhhhHB", MOTION_SYNC, steps[0], steps[1], steps[2], rpm, flags)
+    return data + bytes([crc8(data)])
+
+
+def move(steps, rpm):
+    parts = max(1, -(-max(abs(s) for s in steps) // STEPS_MAX))
+    done = [0, 0, 0]
+    for part in range(1, parts + 1):
+        target = [s * part // parts if s >= 0 else -(-s * part // parts) for s in steps]
+        yield record([t - d for t, d in zip(target, done)], rpm if part == 1 else 0)
+        done = target
+
+
+def convert(lines):
+    for lineno, line in enumerate(lines, 1):
+        line = line.strip()
+        if not line or line.startswith("#"):
+            continue
+        fields = [f.strip() for f in line.split(",")]
+        try:
+            if fields[0].lower() == "dwell":
+                ms = int(fields[1])
+                if ms < 0:
+                    sys.exit("line %d: negative dwell time" % lineno)
+                while ms > 0:
+                    yield record([min(ms, STEPS_MAX), 0, 0], 0, MOTION_DWELL)
+                    ms -= STEPS_MAX
+                continue
+            values = [float(f) for f in fields]
+        except (ValueError, IndexError):
+            sys.exit("line %d: cannot parse '%s'" % (lineno, line))
+        if len(values) == 2:
+            steps, rpm = values + [0], 0
+        elif len(values) == 3:
+            steps, rpm = values, 0
+        elif len(values) == 4:
+            steps, rpm = values[:3], values[3]
+        else:
+            sys.exit("line %d: expected 2-4 values" % lineno)
+        rpm = round(rpm * MOTION_RPM_SCALE)
+        if not 0 <= rpm <= 0xffff:
+            sys.exit("line %d: rpm out of range" % lineno)
+        yield from move([int(s) for s in steps], rpm)
+    yield record([0, 0, 0], 0, MOTION_END)
+
+
+def main():
+    src = open(sys.argv[1]) if len(sys.argv) > 1 else sys.stdin
+    dst = open(sys.argv[2], "wb") if len(sys.argv) > 2 else sys.stdout.buffer
+    for rec in convert(src):
+        dst.write(rec)
+
+
+if __name__ == "__main__":
+    main()
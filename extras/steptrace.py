@@ -0,0 +1,162 @@
+#!/usr/bin/env python3
+#
+# steptrace.py - Summarize and compare step traces recorded with StepRecorder
+#
+# Usage:
+#   extras/steptrace.py show trace.txt
+#   extras/steptrace.py diff expected.txt actual.txt [--tolerance MICROS] [--max N]
+#   extras/steptrace.py replay trace.txt [-o trace.vcd] [--pulse MICROS]
+#
+# A trace is the text written by StepRecorder::print(), one step per line:
+#   <dt> <motor> <dir>      micros since the previous step, motor id, DIR level
+# Other lines (serial output of the sketch, "# lost" reports) are skipped, so a
+# whole serial capture (hardware or simavr) can be used as is.
+#
+# diff compares the steps of each motor in order: direction, and time since the
+# first step of the trace. It reports the first differences beyond the tolerance
+# and exits with status 1 if there are any, so it can gate a regression run.
+#
+# replay plays a trace back as the STEP/DIR waveforms of each motor, written as a
+# VCD file (1us resolution) to view in GTKWave next to a simavr VCD dump or a logic
+# analyzer capture of the same move.
+#
+# Copyright (C)2026 Laurentiu Badea
+#
+# This file may be redistributed under the terms of the MIT license.
+# A copy of this license has been included with this distribution in the file LICENSE.
+
+import argparse
+import re
+import sys
+
+LINE = re.compile(r"^\s*(\d+) (\d) ([01])\s*$")
+
+
+def load(path):
+    """Return {motor: [(time, dir), ...]} with times relative to the first step"""
+    motors = {}
+    time = None
+    lost = 0
+    with open(path, errors="replace") as f:
+        for line in f:
+            line = line.rstrip(".\r\n")
+            if line.startswith("# lost "):
+                lost += int(line.split()[2])
+                continue
+            match = LINE.match(line)
+            if not match:
+                continue
+            dt, motor, direction = (int(g) for g in match.groups())
+            time = 0 if time is None else time + dt
+            motors.setdefault(motor, []).append((time, direction))
+    if lost:
+        print("%s: %d steps lost while recording" % (path, lost), file=sys.stderr)
+    return motors
+
+
+def show(args):
+    motors = load(args.trace)
+    for motor, steps in sorted(motors.items()):
+        position = sum(1 if d else -1 for _, d in steps)
+        intervals = [b[0] - a[0] for a, b in zip(steps, steps[1:])]
+        print("motor %d: %d steps, position %+d, %d..%dus, first %dus last %dus"
+              % (motor, len(steps), position,
+                 min(intervals, default=0), max(intervals, default=0),
+                 steps[0][0], steps[-1][0]))
+    return 0
+
+
+def diff(args):
+    expected = load(args.expected)
+    actual = load(args.actual)
+    differences = 0
+    for motor in sorted(set(expected) | set(actual)):
+        a = expected.get(motor, [])
+        b = actual.get(motor, [])
+        worst = 0
+        for i, ((ta, da), (tb, db)) in enumerate(zip(a, b)):
+            error = tb - ta
+            worst = max(worst, abs(error))
+            if da != db or abs(error) > args.tolerance:
+                differences += 1
+                if differences <= args.max:
+                    print("motor %d step %d at %dus: %s"
+                          % (motor, i, ta, "direction %d, expected %d" % (db, da)
+                             if da != db else "%+dus" % error))
+        if len(a) != len(b):
+            differences += 1
+            print("motor %d: %d steps, expected %d" % (motor, len(b), len(a)))
+        end = (b[-1][0] if b else 0) - (a[-1][0] if a else 0)
+        print("motor %d: worst timing difference %dus, end %+dus" % (motor, worst, end))
+    if differences > args.max:
+        print("... %d differences" % differences)
+    return 1 if differences else 0
+
+
+def replay(args):
+    motors = load(args.trace)
+    # (time, order, signal, value): at equal times STEP falls first, then DIR is set
+    # ahead of the rising STEP edge it is sampled on
+    changes = []
+    for motor, steps in motors.items():
+        for i, (time, direction) in enumerate(steps):
+            end = time + args.pulse
+            if i + 1 < len(steps):
+                end = min(end, steps[i + 1][0])
+            changes.append((time, 1, "dir%d" % motor, direction))
+            changes.append((time, 2, "step%d" % motor, 1))
+            changes.append((end, 0, "step%d" % motor, 0))
+    changes.sort()
+    signals = {}
+    for motor in sorted(motors):
+        for name in ("step%d" % motor, "dir%d" % motor):
+            signals[name] = chr(ord("!") + len(signals))
+    out = open(args.output, "w") if args.output else sys.stdout
+    out.write("$timescale 1us $end\n$scope module steptrace $end\n")
+    for name, code in signals.items():
+        out.write("$var wire 1 %s %s $end\n" % (code, name))
+    out.write("$upscope $end\n$enddefinitions $end\n#0\n$dumpvars\n")
+    levels = {name: 0 for name in signals}
+    for code in signals.values():
+        out.write("0%s\n" % code)
+    out.write("$end\n")
+    time = 0
+    for when, _, name, value in changes:
+        if levels[name] == value:
+            continue
+        if when != time:
+            out.write("#%d\n" % when)
+            time = when
+        out.write("%d%s\n" % (value, signals[name]))
+        levels[name] = value
+    if out is not sys.stdout:
+        out.close()
+    return 0
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Summarize and compare StepRecorder step traces")
+    commands = parser.add_subparsers(dest="command", required=True)
+    parser_show = commands.add_parser("show", help="summarize a trace")
+    parser_show.add_argument("trace")
+    parser_show.set_defaults(run=show)
+    parser_diff = commands.add_parser("diff", help="compare two traces")
+    parser_diff.add_argument("expected")
+    parser_diff.add_argument("actual")
+    parser_diff.add_argument("--tolerance", type=int, default=0,
+                             help="allowed timing difference (micros)")
+    parser_diff.add_argument("--max", type=int, default=20,
+                             help="max differences listed")
+    parser_diff.set_defaults(run=diff)
+    parser_replay = commands.add_parser("replay", help="write a trace as STEP/DIR waveforms (VCD)")
+    parser_replay.add_argument("trace")
+    parser_replay.add_argument("-o", "--output", help="VCD file (default: standard output)")
+    parser_replay.add_argument("--pulse", type=int, default=2,
+                               help="STEP high time (micros)")
+    parser_replay.set_defaults(run=replay)
+    args = parser.parse_args()
+    return args.run(args)
+
+
+if __name__ == "__main__":
+    sys.exit(main())
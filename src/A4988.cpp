@@ -42,15 +42,16 @@ ms1_pin(ms1_pin), ms2_pin(ms2_pin), ms3_pin(ms3_pin)
 { initTiming(); }
 
 void A4988::begin(float rpm, short microsteps){
-    BasicStepperDriver::begin(rpm, microsteps);
-
-    if (!IS_CONNECTED(ms1_pin) || !IS_CONNECTED(ms2_pin) || !IS_CONNECTED(ms3_pin)){
-        return;
+    if (IS_CONNECTED(ms1_pin) && IS_CONNECTED(ms2_pin) && IS_CONNECTED(ms3_pin)){
+        // precompute the MSx pin states so setMicrostep() changes all pins at once
+        ms_pins.begin(ms1_pin, ms2_pin, ms3_pin);
+        const uint8_t* ms_table = getMicrostepTable();
+        size_t ms_table_size = getMicrostepTableSize();
+        for (size_t i = 0; i < ms_table_size; i++){
+            ms_states[i] = ms_pins.prepare(ms_table[i]);
+        }
     }
-
-    pinMode(ms1_pin, OUTPUT);
-    pinMode(ms2_pin, OUTPUT);
-    pinMode(ms3_pin, OUTPUT);
+    BasicStepperDriver::begin(rpm, microsteps);
 }
 
 /*
@@ -61,20 +62,16 @@ void A4988::begin(float rpm, short microsteps){
 short A4988::setMicrostep(short microsteps){
     BasicStepperDriver::setMicrostep(microsteps);
 
-    if (!IS_CONNECTED(ms1_pin) || !IS_CONNECTED(ms2_pin) || !IS_CONNECTED(ms3_pin)){
+    if (!ms_pins.isConnected()){
         return this->microsteps;
     }
 
-    const uint8_t* ms_table = getMicrostepTable();
     size_t ms_table_size = getMicrostepTableSize();
 
     unsigned short i = 0;
     while (i < ms_table_size){
         if (this->microsteps & (1<<i)){
-            uint8_t mask = ms_table[i];
-            digitalWrite(ms3_pin, mask & 4);
-            digitalWrite(ms2_pin, mask & 2);
-            digitalWrite(ms1_pin, mask & 1);
+            ms_pins.apply(ms_states[i]);
             break;
         }
         i++;
@@ -11,6 +11,7 @@
 #define A4988_H
 #include <Arduino.h>
 #include "BasicStepperDriver.h"
+#include "PinGroup.h"
 
 class A4988 : public BasicStepperDriver {
 protected:
@@ -18,6 +19,9 @@ protected:
     short ms1_pin = PIN_UNCONNECTED;
     short ms2_pin = PIN_UNCONNECTED;
     short ms3_pin = PIN_UNCONNECTED;
+    // MSx pins and their precomputed states for each microstep level
+    PinGroup ms_pins;
+    PinGroup::State ms_states[PIN_GROUP_MAX_STATES];
     // Set timing requirements from A4988 datasheet
     void initTiming(){
         // tA STEP HIGH pulse duration, min value (1us)
@@ -30,6 +30,39 @@ constexpr const T& stepperMax(const T& a, const T& b)
     return a < b ? b : a;
 }
 
+template<typename T>
+constexpr T stepperAbs(T a)
+{
+    return a < 0 ? -a : a;
+}
+
+/*
+ * Ramps (accelerating or braking) are capped at this many microsteps so the step
+ * index in the speed recurrence divisor (4n+1) fits 32 bits, also with 64-bit moves.
+ * Only reached with extreme rpm/microstep/acceleration combinations.
+ */
+static const long MAX_RAMP_STEPS = 0x3FFFFFFEL;
+
+static long rampSteps(float steps){
+    return (steps < MAX_RAMP_STEPS) ? (long)steps : MAX_RAMP_STEPS;
+}
+
+/*
+ * Exact ramp intervals relative to the first one, sqrt(n+1) - sqrt(n), in 1/65536
+ * (65535 for 1), used instead of the approximation for the first steps of the ramps
+ */
+static const unsigned char RAMP_TABLE_SIZE = 16;
+static const uint16_t RAMP_TABLE[RAMP_TABLE_SIZE] PROGMEM = {
+    65535, 27146, 20830, 17560, 15471, 13987, 12862, 11972,
+    11244, 10635, 10115, 9665, 9270, 8920, 8607, 8324
+};
+
+// c0 * RAMP_TABLE[n] / 65536 with 32-bit multiplies only
+static inline long rampPulse(unsigned long c0, unsigned char n){
+    unsigned long ratio = pgm_read_word(&RAMP_TABLE[n]);
+    return (c0 >> 16) * ratio + (((c0 & 0xFFFF) * ratio) >> 16);
+}
+
 /*
  * Basic connection: only DIR, STEP are connected.
  * Microstepping controls should be hardwired.
@@ -39,6 +72,9 @@ BasicStepperDriver::BasicStepperDriver(short steps, short dir_pin, short step_pi
 {
 }
 
+volatile bool BasicStepperDriver::emergency = false;
+bool BasicStepperDriver::emergency_disable = false;
+
 BasicStepperDriver::BasicStepperDriver(short steps, short dir_pin, short step_pin, short enable_pin)
 :motor_steps(steps), dir_pin(dir_pin), step_pin(step_pin), enable_pin(enable_pin)
 {
@@ -70,7 +106,8 @@ void BasicStepperDriver::begin(float rpm, short microsteps){
     this->rpm = rpm;
     setMicrostep(microsteps);
 
-    enable();
+    // the first move waits out the driver wakeup time, if still needed
+    startEnable();
 }
 
 /*
@@ -114,10 +151,14 @@ void BasicStepperDriver::setSpeedProfile(struct Profile profile){
  * Move the motor a given number of steps.
  * positive to move forward, negative to reverse
  */
-void BasicStepperDriver::move(long steps){
+void BasicStepperDriver::move(steps_t steps){
     startMove(steps);
     while (nextAction());
 }
+void BasicStepperDriver::move(Segment* segments, short count){
+    startMove(segments, count);
+    while (nextAction());
+}
 /*
  * Move the motor a given number of degrees (1-360)
  */
@@ -136,18 +177,66 @@ void BasicStepperDriver::rotate(double deg){
 /*
  * Set up a new move (calculate and save the parameters)
  */
-void BasicStepperDriver::startMove(long steps, long time){
+void BasicStepperDriver::startMove(steps_t steps, move_time_t time){
+    calcMove(steps, time);
+    startMotion();
+}
+/*
+ * Set up a multi-segment move
+ */
+void BasicStepperDriver::startMove(Segment* segments, short count){
+    steps_remaining = planSegments(segments, count);
+    position_origin = getPosition();
+    step_count = 0;
+    rest = 0;
+    this->segments = segments;
+    segment_count = count;
+    segment_index = 0;
+    segment_end = steps_remaining;
+    if (count){
+        nextSegment();
+    }
+    publishStatus();
+    startMotion();
+}
+void BasicStepperDriver::startMotion(void){
+    move_count++;
+    idle_timing = false;
+    last_action_due = 0;
+    next_action_interval = 0;
+    if (!enabled && auto_power_timeout && steps_remaining){
+        startEnable();
+    }
+    if (waking){
+        // schedule the first step after the driver wakeup time instead of waiting for it
+        unsigned long wait = stepperMax((short)2, wakeup_time);
+        if (micros() - wake_start < wait){
+            last_action_due = wake_start;
+            next_action_interval = wait;
+        }
+        waking = false;
+    }
+}
+/*
+ * Calculate the profile parameters for a move
+ */
+void BasicStepperDriver::calcMove(steps_t steps, move_time_t time){
     float speed;
     // set up new move
+    position_origin = getPosition();
     dir_state = (steps >= 0) ? HIGH : LOW;
-    last_action_end = 0;
-    steps_remaining = labs(steps);
+    steps_remaining = stepperAbs(steps);
     step_count = 0;
     rest = 0;
+    segments = nullptr;
+    segment_count = 0;
+    segment_end = 0;
+    accel_n = 0;
+    decel_n = 0;
     switch (profile.mode){
     case LINEAR_SPEED:
         // speed is in [steps/s]
-        speed = rpm * motor_steps / 60;
+        speed = limitRPM(rpm) * motor_steps / 60;
         if (time > 0){
             // Calculate a new speed to finish in the time requested
             float t = time / (1e+6);                  // convert to seconds
@@ -159,42 +248,213 @@ void BasicStepperDriver::startMove(long steps, long time){
             };
         }
         // how many microsteps from 0 to target speed
-        steps_to_cruise = microsteps * (speed * speed / (2 * profile.accel));
+        steps_to_cruise = rampSteps(microsteps * (speed * speed / (2 * profile.accel)));
         // how many microsteps are needed from cruise speed to a full stop
         // (calculated from speed like steps_to_cruise, to avoid 32-bit overflow
         // of steps_to_cruise * accel with high microstep/rpm/accel combinations)
-        steps_to_brake = microsteps * (speed * speed / (2 * profile.decel));
+        steps_to_brake = rampSteps(microsteps * (speed * speed / (2 * profile.decel)));
         if (steps_remaining < steps_to_cruise + steps_to_brake){
             // cannot reach max speed, will need to brake early
-            steps_to_cruise = steps_remaining * profile.decel / (profile.accel + profile.decel);
+            // (split so steps_remaining * decel cannot overflow)
+            long a = profile.accel + profile.decel;
+            steps_to_cruise = steps_remaining / a * profile.decel + steps_remaining % a * profile.decel / a;
             steps_to_brake = steps_remaining - steps_to_cruise;
         }
-        // Initial pulse (c0) including error correction factor 0.676 [us]
-        step_pulse = (1e+6)*0.676*sqrt(2.0f/profile.accel/microsteps);
+        if (exact_ramps){
+            // exact first pulse of each ramp, the table takes it from there [us]
+            accel_c0 = step_pulse = (1e+6)*sqrt(2.0f/profile.accel/microsteps);
+            decel_c0 = (1e+6)*sqrt(2.0f/profile.decel/microsteps);
+        } else {
+            // Initial pulse (c0) including error correction factor 0.676 [us]
+            step_pulse = (1e+6)*0.676*sqrt(2.0f/profile.accel/microsteps);
+        }
         // Save cruise timing since we will no longer have the calculated target speed later
         cruise_step_pulse = 1e+6 / speed / microsteps;
         // If target speed is reached within the first step (steps_to_cruise == 0),
         // the accelerating state is never entered and c0 would be used for the entire
         // move, which is faster than the cruise speed. Start at cruise speed instead.
         step_pulse = stepperMax(step_pulse, cruise_step_pulse);
+        move_step_pulse = cruise_step_pulse * feed;
         break;
 
     case CONSTANT_SPEED:
     default:
         steps_to_cruise = 0;
         steps_to_brake = 0;
-        step_pulse = cruise_step_pulse = STEP_PULSE(motor_steps, microsteps, rpm);
+        step_pulse = cruise_step_pulse = STEP_PULSE(motor_steps, microsteps, limitRPM(rpm));
         // compare in float to avoid 32-bit overflow of steps_remaining * step_pulse
         if (steps_remaining && time > (float)steps_remaining * step_pulse){
             step_pulse = (float)time / steps_remaining;
         }
+        move_step_pulse = step_pulse * feed;
+    }
+    publishStatus();
+}
+/*
+ * Plan a segment list: entry/exit speeds and ramp lengths of each segment.
+ * The exit speeds are limited backward first, so that a segment can slow down to the
+ * speeds after it within its length, then forward, so that it can reach them from
+ * its entry speed; a short segment thus lowers the speeds before it instead of
+ * making the step pulse jump.
+ */
+steps_t BasicStepperDriver::planSegments(Segment* segments, short count){
+    // speeds in [full steps/s], the neighbors' count only if moving the same way
+    for (short i = count-1; i >= 0; i--){
+        Segment& segment = segments[i];
+        segment.speed_out = 0;
+        if (i < count-1 && (segments[i+1].steps >= 0) == (segment.steps >= 0)){
+            const Segment& next = segments[i+1];
+            segment.speed_out = stepperMin(limitRPM(segment.rpm), limitRPM(next.rpm)) * motor_steps / 60;
+            if (next.accel > 0){
+                float slowdown = 2.0 * next.accel * stepperAbs(next.steps) / microsteps;
+                segment.speed_out = stepperMin(segment.speed_out, (float)sqrt(next.speed_out * next.speed_out + slowdown));
+            }
+        }
+    }
+    steps_t total = 0;
+    for (short i = 0; i < count; i++){
+        Segment& segment = segments[i];
+        steps_t steps = stepperAbs(segment.steps);
+        total += steps;
+        float speed = limitRPM(segment.rpm) * motor_steps / 60;
+        float speed_in = 0;
+        if (i > 0 && (segments[i-1].steps >= 0) == (segment.steps >= 0)){
+            speed_in = segments[i-1].speed_out;
+        }
+        if (segment.accel > 0){
+            float speedup = 2.0 * segment.accel * steps / microsteps;
+            segment.speed_out = stepperMin(segment.speed_out, (float)sqrt(speed_in * speed_in + speedup));
+        }
+        float speed_out = segment.speed_out;
+        segment.ramp_up = segment.ramp_down = 0;
+        segment.n_in = segment.n_out = 0;
+        if (segment.accel > 0){
+            // ramp step index (microsteps from standstill) of each speed
+            float k = microsteps / (2.0 * segment.accel);
+            long n_top = rampSteps(k * speed * speed);
+            segment.n_in = rampSteps(k * speed_in * speed_in);
+            segment.n_out = rampSteps(k * speed_out * speed_out);
+            if (2 * n_top - segment.n_in - segment.n_out > steps){
+                // cannot reach the target speed, turn around at the middle
+                // (same as (steps + n_in + n_out) / 2, without overflowing)
+                n_top = segment.n_in + (steps - segment.n_in + segment.n_out) / 2;
+                speed = sqrt(n_top / k);
+            }
+            segment.ramp_up = stepperMin(steps, (steps_t)stepperMax(0L, n_top - segment.n_in));
+            segment.ramp_down = stepperMax((steps_t)0, stepperMin(steps - segment.ramp_up, (steps_t)(n_top - segment.n_out)));
+        }
+        segment.cruise_pulse = 1e+6 / speed / microsteps;
+        segment.ramp_c0 = (segment.accel > 0) ? (1e+6)*sqrt(2.0f/segment.accel/microsteps) : 0;
+        segment.start_pulse = 0;
+        if (speed_in == 0){
+            // c0 with the same correction factor as single moves
+            long c0 = (exact_ramps) ? segment.ramp_c0 : 0.676 * segment.ramp_c0;
+            segment.start_pulse = stepperMax(segment.cruise_pulse, c0);
+        }
+    }
+    return total;
+}
+/*
+ * Load the next segment of a multi-segment move, as thresholds and ramp offsets
+ * relative to the whole move.
+ * Returns true if it starts from standstill (step pulse reset to c0).
+ */
+bool BasicStepperDriver::nextSegment(void){
+    const Segment& segment = segments[segment_index++];
+    short dir = (segment.steps >= 0) ? HIGH : LOW;
+    if (dir != dir_state){
+        // keep getPosition() continuous when the direction changes mid-move
+        position_origin += (dir_state == HIGH) ? 2 * step_count : -2 * step_count;
+        dir_state = dir;
+    }
+    segment_end -= stepperAbs(segment.steps);
+    steps_to_cruise = step_count + segment.ramp_up;
+    accel_n = segment.n_in - step_count;
+    steps_to_brake = segment_end + segment.ramp_down;
+    decel_n = segment.n_out - segment_end;
+    cruise_step_pulse = segment.cruise_pulse;
+    accel_c0 = decel_c0 = segment.ramp_c0;
+    if (segment.start_pulse){
+        step_pulse = segment.start_pulse;
+        rest = 0;
+        return true;
+    }
+    return false;
+}
+/*
+ * Feed override: the following moves are planned for rpm * feed, the move in progress
+ * changes to it from its planned speed
+ */
+void BasicStepperDriver::setFeedOverride(float factor){
+    feed = stepperMin(stepperMax(factor, (float)MIN_FEED_OVERRIDE), (float)MAX_FEED_OVERRIDE);
+    if (canChangeSpeed()){
+        changeSpeed(60.0*1000000L * feed / move_step_pulse / microsteps / motor_steps);
+    }
+}
+/*
+ * Replan the rest of the move in progress for a new cruise speed.
+ * Speeds are handled as ramp step indexes, n = microsteps * speed^2 / (2 * accel)
+ * [full steps/s], so the speed change continues the step pulse series from the
+ * current step pulse, like the ramps between the segments of a multi-segment move.
+ */
+void BasicStepperDriver::changeSpeed(float rpm, float accel_scale, float decel_scale){
+    if (!canChangeSpeed()){
+        return;
+    }
+    long pulse = STEP_PULSE(motor_steps, microsteps, rpm);
+    if (pulse < (long)min_step_interval){
+        pulse = min_step_interval;
+    }
+    cruise_step_pulse = pulse;
+    if (profile.mode != LINEAR_SPEED){
+        step_pulse = pulse;
+        publishStatus();
+        return;
+    }
+    float ka = microsteps / (2.0 * profile.accel * accel_scale);
+    float kd = microsteps / (2.0 * profile.decel * decel_scale);
+    float speed = 1e+6 / step_pulse / microsteps;
+    float target = 1e+6 / pulse / microsteps;
+    // steps to a stop from the new speed, at the end of the move
+    steps_t brake = rampSteps(kd * target * target);
+    rest = 0;
+    segment_end = 0;
+    decel_n = 0;
+    if (exact_ramps){
+        accel_c0 = (1e+6)*sqrt(2.0f/profile.accel/accel_scale/microsteps);
+        decel_c0 = (1e+6)*sqrt(2.0f/profile.decel/decel_scale/microsteps);
+    }
+    if (target >= speed){
+        // accelerate from the current ramp index (at least 1, the series starts there)
+        long n = stepperMax(1L, rampSteps(ka * speed * speed));
+        steps_t up = stepperMax(0L, rampSteps(ka * target * target) - n);
+        if (up + brake > steps_remaining){
+            // cannot reach the new speed, turn around where the brake takes the rest
+            long peak = (steps_remaining + n) / (1 + kd / ka);
+            up = stepperMax(0L, peak - n);
+            brake = steps_remaining - up;
+        }
+        steps_to_cruise = step_count + up;
+        accel_n = n - step_count;
+        steps_to_brake = brake;
+    } else {
+        long n = rampSteps(kd * speed * speed);
+        steps_to_cruise = step_count;
+        steps_to_brake = steps_remaining;
+        if (n < steps_remaining){
+            // decelerate until segment_end, then cruise (see calcStepPulse());
+            // the brake to a stop is segment_end + decel_n
+            segment_end = steps_remaining - (n - brake);
+            decel_n = brake - segment_end;
+        }
     }
+    publishStatus();
 }
 /*
  * Alter a running move by adding/removing steps
  * FIXME: This is a naive implementation and it only works well in CRUISING state
  */
-void BasicStepperDriver::alterMove(long steps){
+void BasicStepperDriver::alterMove(steps_t steps){
     switch (getCurrentState()){
     case ACCELERATING: // this also works but will keep the original speed target
     case CRUISING:
@@ -211,11 +471,38 @@ void BasicStepperDriver::alterMove(long steps){
         startMove(steps);
         break;
     }
+    publishStatus();
 }
 /*
  * Brake early.
  */
 void BasicStepperDriver::startBrake(void){
+    if (!segments && segment_end){
+        // slowing down for changeSpeed(): brake from the current ramp index instead
+        steps_remaining += decel_n;
+        steps_to_brake = steps_remaining;
+        segment_end = 0;
+        decel_n = 0;
+        publishStatus();
+        return;
+    }
+    if (segments && steps_remaining > 0){
+        // from the current speed, with the current segment's acceleration
+        short accel = segments[segment_index-1].accel;
+        steps_t steps = 0;
+        if (accel > 0){
+            float speed = 1e+6 / step_pulse / microsteps;
+            steps = rampSteps(microsteps * speed * speed / (2.0 * accel));
+        }
+        if (steps < steps_remaining){
+            steps_remaining = steps_to_brake = steps;
+            segment_index = segment_count;
+            segment_end = 0;
+            decel_n = 0;
+        }
+        publishStatus();
+        return;
+    }
     switch (getCurrentState()){
     case CRUISING:  // this applies to both CONSTANT_SPEED and LINEAR_SPEED modes
         steps_remaining = steps_to_brake;
@@ -224,36 +511,38 @@ void BasicStepperDriver::startBrake(void){
     case ACCELERATING:
         // compare in float to avoid 32-bit overflow of step_count * profile.accel
         // with high microstep/rpm/accel combinations (same pattern as startMove())
-        steps_remaining = (float)step_count * profile.accel / profile.decel;
+        steps_remaining = rampSteps((float)(step_count + accel_n) * profile.accel / profile.decel);
         break;
 
     default:
         break; // nothing to do if already stopped or braking
     }
+    publishStatus();
 }
 /*
  * Stop movement immediately and return remaining steps.
  */
-long BasicStepperDriver::stop(void){
-    long retval = steps_remaining;
+steps_t BasicStepperDriver::stop(void){
+    steps_t retval = steps_remaining;
     steps_remaining = 0;
+    publishStatus();
     return retval;
 }
 /*
  * Return calculated time to complete the given move
  */
-long BasicStepperDriver::getTimeForMove(long steps){
+move_time_t BasicStepperDriver::getTimeForMove(steps_t steps){
     float t;
-    long cruise_steps;
+    steps_t cruise_steps;
     float speed;
     if (steps == 0){
         return 0;
     }
     switch (profile.mode){
         case LINEAR_SPEED:
-            startMove(steps);
+            calcMove(steps);
             cruise_steps = steps_remaining - steps_to_cruise - steps_to_brake;
-            speed = rpm * motor_steps / 60;   // full steps/s
+            speed = limitRPM(rpm) * motor_steps / 60;   // full steps/s
             t = (cruise_steps / (microsteps * speed)) +
                 sqrt(2.0 * steps_to_cruise / profile.accel / microsteps) +
                 sqrt(2.0 * steps_to_brake / profile.decel / microsteps);
@@ -261,10 +550,30 @@ long BasicStepperDriver::getTimeForMove(long steps){
             break;
         case CONSTANT_SPEED:
         default:
-            t = steps * STEP_PULSE(motor_steps, microsteps, rpm);
+            t = steps * STEP_PULSE(motor_steps, microsteps, limitRPM(rpm));
+    }
+    if (fabs(t) >= MOVE_TIME_MAX){
+        return (t > 0) ? MOVE_TIME_MAX : -MOVE_TIME_MAX;
     }
     return round(t);
 }
+move_time_t BasicStepperDriver::getTimeForMove(Segment* segments, short count){
+    float t = 0;
+    planSegments(segments, count);
+    for (short i = 0; i < count; i++){
+        const Segment& segment = segments[i];
+        float speed = 1e+6 / segment.cruise_pulse / microsteps;
+        steps_t cruise_steps = stepperAbs(segment.steps) - segment.ramp_up - segment.ramp_down;
+        t += cruise_steps / (microsteps * speed);
+        if (segment.accel > 0){
+            // ramp time is the speed change over the acceleration
+            float k = 2.0 * segment.accel / microsteps;
+            t += (2 * speed - sqrt(k * segment.n_in) - sqrt(k * segment.n_out)) / segment.accel;
+        }
+    }
+    t *= 1e+6;
+    return (t < MOVE_TIME_MAX) ? round(t) : MOVE_TIME_MAX;
+}
 /*
  * Move the motor an integer number of degrees (360 = full rotation)
  * This has poor precision for small amounts, since step is usually 1.8deg
@@ -288,15 +597,38 @@ void BasicStepperDriver::calcStepPulse(void){
     if (steps_remaining <= 0){  // this should not happen, but avoids strange calculations
         return;
     }
-    steps_remaining--;
-    step_count++;
+    steps_remaining -= step_size;
+    step_count += step_size;
+
+    if (steps_remaining <= segment_end){
+        if (segment_index < segment_count){
+            if (nextSegment()){
+                return;
+            }
+        } else if (segment_end){
+            // end of a speed change slowdown, cruise at the new speed
+            steps_to_brake = segment_end + decel_n;
+            segment_end = 0;
+            decel_n = 0;
+            step_pulse = cruise_step_pulse;
+            rest = 0;
+            return;
+        }
+    }
 
-    if (profile.mode == LINEAR_SPEED){
+    if (profile.mode == LINEAR_SPEED || segments){
         switch (getCurrentState()){
         case ACCELERATING:
             if (step_count < steps_to_cruise){
+                // the ramp index fits 32 bits (MAX_RAMP_STEPS) also with 64-bit moves
+                unsigned long n = (unsigned long)step_count + accel_n;
+                if (exact_ramps && n < RAMP_TABLE_SIZE){
+                    step_pulse = rampPulse(accel_c0, n);
+                    rest = 0;
+                    break;
+                }
                 // unsigned division is faster than signed on MCUs without hardware divide
-                unsigned long divisor = 4 * step_count + 1;
+                unsigned long divisor = 4 * n + 1;
                 unsigned long dividend = 2 * step_pulse + rest;
                 step_pulse -= dividend / divisor;
                 rest = dividend % divisor;
@@ -311,10 +643,23 @@ void BasicStepperDriver::calcStepPulse(void){
             {
                 // same series as acceleration with negative n = -steps_remaining;
                 // kept in unsigned form: c -= 2c/(-4n+1) is identical to c += 2c/(4n-1)
-                unsigned long divisor = 4 * steps_remaining - 1;
+                unsigned long n = (unsigned long)steps_remaining + decel_n;
+                // this pulse follows the next step, which leaves n-1 steps to a stop
+                if (exact_ramps && n - 1 < RAMP_TABLE_SIZE){
+                    step_pulse = rampPulse(decel_c0, n - 1);
+                    rest = 0;
+                    break;
+                }
+                unsigned long divisor = 4 * n - 1;
                 unsigned long dividend = 2 * step_pulse + rest;
                 step_pulse += dividend / divisor;
                 rest = dividend % divisor;
+                if (segment_end && !segments && step_pulse > cruise_step_pulse){
+                    // slowing down for changeSpeed(): the series overshoots the new
+                    // speed near the bottom of the ramp, hold it instead
+                    step_pulse = cruise_step_pulse;
+                    rest = 0;
+                }
             }
             break;
 
@@ -323,52 +668,272 @@ void BasicStepperDriver::calcStepPulse(void){
         }
     }
 }
+/*
+ * Toggle STEP for one step and calculate the time until the next one is due
+ */
+void BasicStepperDriver::emitStep(void){
+    if (emergency){
+        abortMove();
+        return;
+    }
+    if (notify_state){
+        checkState();
+    }
+    /*
+     * DIR pin is sampled on rising STEP edge, so it is set first
+     */
+    digitalWrite(dir_pin, dir_state);
+    digitalWrite(step_pin, HIGH);
+    unsigned long start = micros();
+    if (recorder){
+        recorder->record(start, recorder_flags | (dir_state == HIGH));
+    }
+    unsigned long pulse = step_pulse; // save value because calcStepPulse() will overwrite it
+    calcStepPulse();
+    publishStatus();
+    // We should pull HIGH for at least 1-2us (step_high_min)
+    delayMicros(step_high_min);
+    digitalWrite(step_pin, LOW);
+    if (notify_state && steps_remaining <= 0){
+        // last step: notify STOPPED now rather than when the caller next polls
+        checkState();
+    }
+    unsigned long elapsed = micros();
+    /*
+     * The next step is due one pulse after this one was due, not after it ended, so the
+     * time spent here does not add up over the move and a late step is made up on the
+     * next one. The first step, or one late by a whole pulse, starts the schedule over:
+     * the lost time is skipped instead of being made up with a burst of steps.
+     */
+    unsigned long due = last_action_due + next_action_interval;
+    if (!last_action_due || start - due >= pulse){
+        due = start;
+    }
+    last_action_due = due;
+    elapsed -= due;
+    // floor the STEP LOW interval at step_low_min (datasheet tWL) instead of 1us
+    next_action_interval = (pulse > elapsed + step_low_min) ? pulse : elapsed + step_low_min;
+}
+/*
+ * Measure the shortest sustainable step interval.
+ * Runs the emitStep() work for a number of accelerating steps (the slowest profile
+ * calculation) with STEP left alone, then restores the stopped state.
+ */
+unsigned BasicStepperDriver::calibrate(void){
+    const short samples = 64;
+    if (steps_remaining > 0){
+        return min_step_interval;
+    }
+    steps_t position = getPosition();
+    short dir = dir_state;
+    struct Profile saved = profile;
+    profile.mode = LINEAR_SPEED;
+    calcMove(0x10000L);
+    steps_to_cruise = steps_remaining;
+    steps_to_brake = 0;
+    step_pulse = 1000000L;
+
+    unsigned long start = micros();
+    unsigned long last = start;
+    for (short i = 0; i < samples; i++){
+        delayMicros(step_low_min, last);
+        // DIR is written where emitStep() writes STEP, at the same cost
+        digitalWrite(dir_pin, dir);
+        digitalWrite(dir_pin, dir);
+        micros();   // emitStep() reads the time here
+        calcStepPulse();
+        publishStatus();
+        delayMicros(step_high_min);
+        digitalWrite(dir_pin, dir);
+        last = micros();
+    }
+    // the wait before each step can overrun by one pass of its micros() loop
+    min_step_interval = (last - start + samples - 1) / samples + (micros() - last);
+
+    profile = saved;
+    steps_remaining = 0;
+    step_count = 0;
+    dir_state = dir;
+    position_origin = position;
+    publishStatus();
+    return min_step_interval;
+}
 /*
  * Yield to step control
  * Toggle step and return time until next change is needed (micros)
  */
 long BasicStepperDriver::nextAction(void){
     if (steps_remaining > 0){
-        delayMicros(next_action_interval, last_action_end);
-        /*
-         * DIR pin is sampled on rising STEP edge, so it is set first
-         */
-        digitalWrite(dir_pin, dir_state);
-        digitalWrite(step_pin, HIGH);
-        unsigned m = micros();
-        unsigned long pulse = step_pulse; // save value because calcStepPulse() will overwrite it
-        calcStepPulse();
-        // We should pull HIGH for at least 1-2us (step_high_min)
-        delayMicros(step_high_min);
-        digitalWrite(step_pin, LOW);
-        // account for calcStepPulse() execution time; sets ceiling for max rpm on slower MCUs
-        last_action_end = micros();
-        m = last_action_end - m;
-        // floor the STEP LOW interval at step_low_min (datasheet tWL) instead of 1us
-        unsigned low_min = (unsigned)step_low_min;
-        next_action_interval = (pulse > m + low_min) ? pulse - m : low_min;
+        delayMicros(next_action_interval, last_action_due);
+        emitStep();
     } else {
         // end of move
-        last_action_end = 0;
+        last_action_due = 0;
         next_action_interval = 0;
+        stopped(micros());
     }
     return next_action_interval;
 }
+/*
+ * Non-blocking step control
+ * Toggle step only if due, return whether the move is still in progress
+ */
+bool BasicStepperDriver::service(unsigned long now){
+    if (emergency && steps_remaining > 0){
+        // don't wait for the next step to be due
+        abortMove();
+    }
+    if (steps_remaining <= 0){
+        // end of move
+        last_action_due = 0;
+        next_action_interval = 0;
+        stopped(now);
+        return false;
+    }
+    if (now - last_action_due >= next_action_interval){
+        emitStep();
+    }
+    return true;
+}
 
-enum BasicStepperDriver::State BasicStepperDriver::getCurrentState(void){
-    enum State state;
+/*
+ * Single step outside of a move
+ */
+void BasicStepperDriver::step(int direction){
+    if (emergency){
+        return;
+    }
+    delayMicros(wake());
+    position_origin += (direction > 0) ? 1 : -1;
+    digitalWrite(dir_pin, (direction > 0) ? HIGH : LOW);
+    digitalWrite(step_pin, HIGH);
+    if (recorder){
+        recorder->record(micros(), recorder_flags | (direction > 0));
+    }
+    delayMicros(step_high_min);
+    digitalWrite(step_pin, LOW);
+    delayMicros(step_low_min);
+}
+
+void BasicStepperDriver::queueSteps(steps_t steps){
+    if (!steps || emergency){
+        return;
+    }
+    if (steps_remaining > 0 && !segments){
+        steps_t pending = (dir_state == HIGH) ? steps_remaining : -steps_remaining;
+        if ((pending > 0) == (pending + steps > 0) && pending + steps){
+            // same direction: keep the schedule of the steps in progress
+            steps_remaining = stepperAbs(pending + steps);
+            publishStatus();
+            return;
+        }
+        steps += pending;
+        if (!steps){
+            steps_remaining = 0;
+            publishStatus();
+            return;
+        }
+    }
+    // a move with no ramps (always CRUISING) at the shortest pulse emitStep() allows
+    position_origin = getPosition();
+    dir_state = (steps > 0) ? HIGH : LOW;
+    steps_remaining = stepperAbs(steps);
+    step_count = 0;
+    rest = 0;
+    segments = nullptr;
+    segment_count = 0;
+    segment_end = 0;
+    accel_n = decel_n = 0;
+    steps_to_cruise = steps_to_brake = 0;
+    step_pulse = cruise_step_pulse = move_step_pulse = step_high_min + step_low_min;
+    publishStatus();
+    startMotion();
+}
+
+long BasicStepperDriver::nextProfileStep(void){
+    if (emergency){
+        abortMove();
+    }
     if (steps_remaining <= 0){
-        state = STOPPED;
-    } else {
-        if (steps_remaining <= steps_to_brake){
-            state = DECELERATING;
-        } else if (step_count <= steps_to_cruise){
-            state = ACCELERATING;
-        } else {
-            state = CRUISING;
+        return 0;
+    }
+    long pulse = step_pulse;
+    calcStepPulse();
+    // the profile steps are not taken by this motor
+    position_origin -= (dir_state == HIGH) ? step_size : -step_size;
+    publishStatus();
+    return pulse;
+}
+
+/*
+ * Drop the move on emergency stop
+ */
+void BasicStepperDriver::abortMove(void){
+    steps_remaining = 0;
+    segment_index = segment_count;
+    next_action_interval = 0;
+    publishStatus();
+    if (emergency_disable){
+        disable();
+    }
+}
+
+/*
+ * Housekeeping while stopped: state notifications and automatic power off
+ */
+void BasicStepperDriver::stopped(unsigned long now){
+    if (notify_state){
+        checkState();
+        idle(now);
+    }
+    if (emergency && emergency_disable && enabled){
+        disable();
+    }
+    if (auto_power_timeout && enabled){
+        // in ms, idle times longer than the micros() wrap (71 minutes) still work
+        unsigned long ms = millis();
+        if (!idle_timing){
+            idle_start = ms;
+            idle_timing = true;
+        } else if (ms - idle_start >= auto_power_timeout){
+            disable();
         }
     }
-    return state;
+}
+
+unsigned long BasicStepperDriver::getTimeToNextAction(unsigned long now){
+    unsigned long elapsed = now - last_action_due;
+    if (steps_remaining <= 0 || elapsed >= next_action_interval){
+        return 0;
+    }
+    return next_action_interval - elapsed;
+}
+
+enum BasicStepperDriver::State BasicStepperDriver::getCurrentState(void){
+    return calcState(step_count, steps_remaining, steps_to_cruise, steps_to_brake);
+}
+/*
+ * Read the status snapshot, retrying if the stepping path updated it meanwhile
+ */
+struct BasicStepperDriver::Status BasicStepperDriver::getStatus(void){
+    Status status;
+    steps_t to_cruise, to_brake;
+    short size;
+    unsigned char seq;
+    do {
+        seq = status_seq;
+        STATUS_BARRIER();
+        status.steps_completed = status_step_count;
+        status.steps_remaining = status_steps_remaining;
+        status.step_pulse = status_step_pulse;
+        to_cruise = status_steps_to_cruise;
+        to_brake = status_steps_to_brake;
+        size = status_step_size;
+        STATUS_BARRIER();
+    } while ((seq & 1) || seq != status_seq);
+    status.state = calcState(status.steps_completed, status.steps_remaining, to_cruise, to_brake);
+    status.rpm = (status.state != STOPPED) ? 60.0*1000000L * size / status.step_pulse / microsteps / motor_steps : 0;
+    return status;
 }
 /*
  * Configure which logic state on ENABLE pin means active
@@ -381,18 +946,44 @@ void BasicStepperDriver::setEnableActiveState(short state){
  * Enable/Disable the motor by setting a digital flag
  */
 void BasicStepperDriver::enable(void){
+    delayMicros(startEnable());
+    waking = false;
+}
+
+short BasicStepperDriver::startEnable(void){
     if IS_CONNECTED(enable_pin){
         digitalWrite(enable_pin, enable_active_state);
     };
-    // wait the driver's wakeup time (datasheet tWAKE) before stepping,
+    enabled = true;
+    waking = true;
+    wake_start = micros();
+    // the driver's wakeup time (datasheet tWAKE) before stepping,
     // but at least 2us as the base default wakeup_time is 0
-    delayMicros(stepperMax((short)2, wakeup_time));
+    return stepperMax((short)2, wakeup_time);
+}
+
+short BasicStepperDriver::wake(void){
+    idle_timing = false;
+    if (!enabled && auto_power_timeout){
+        startEnable();
+    }
+    if (waking){
+        unsigned long wait = stepperMax((short)2, wakeup_time);
+        unsigned long elapsed = micros() - wake_start;
+        if (elapsed < wait){
+            return wait - elapsed;
+        }
+        waking = false;
+    }
+    return 0;
 }
 
 void BasicStepperDriver::disable(void){
     if IS_CONNECTED(enable_pin){
         digitalWrite(enable_pin, (enable_active_state == HIGH) ? LOW : HIGH);
     }
+    enabled = false;
+    waking = false;
 }
 
 short BasicStepperDriver::getMaxMicrostep(){
@@ -10,6 +10,7 @@
 #ifndef STEPPER_DRIVER_BASE_H
 #define STEPPER_DRIVER_BASE_H
 #include <Arduino.h>
+#include "StepRecorder.h"
 
 // used internally by the library to mark unconnected pins
 #define PIN_UNCONNECTED -1
@@ -23,6 +24,37 @@
 
 // don't call yield if we have a wait shorter than this
 #define MIN_YIELD_MICROS 50
+// range of setFeedOverride()
+#define MIN_FEED_OVERRIDE 0.1
+#define MAX_FEED_OVERRIDE 2.0
+
+/*
+ * Move and position counters (microsteps).
+ * 32-bit long overflows after 2^31 microsteps, about 4.5 hours at 1/128 and 300 RPM.
+ * Build with STEPPER_LONG_MOVES defined (e.g. -DSTEPPER_LONG_MOVES) for 64-bit counters,
+ * for continuous rotation or positions beyond that. The per-step profile math stays
+ * 32-bit either way.
+ * Move times (micros) widen with them: 32-bit ones saturate at 2^31-1, about 36 minutes.
+ */
+#ifdef STEPPER_LONG_MOVES
+typedef long long steps_t;
+typedef long long move_time_t;
+#define MOVE_TIME_MAX 0x7FFFFFFFFFFFFFFFLL
+#else
+typedef long steps_t;
+typedef long move_time_t;
+#define MOVE_TIME_MAX 0x7FFFFFFFL
+#endif
+
+/*
+ * Memory barrier for the status snapshot sequence counter.
+ * volatile ordering is enough on single-core AVR; elsewhere the reader may run on another core.
+ */
+#ifdef __AVR__
+#define STATUS_BARRIER()
+#else
+#define STATUS_BARRIER() __sync_synchronize()
+#endif
 
 /*
  * Basic Stepper Driver class.
@@ -37,6 +69,42 @@ public:
         short accel = 1000;     // acceleration [steps/s^2]
         short decel = 1000;     // deceleration [steps/s^2]    
     };
+    /*
+     * One velocity segment of a multi-segment move, see startMove(segments, count).
+     * Speed changes up happen at the start of the faster segment, speed changes down at
+     * the end of the faster segment, and the move stops where the direction changes.
+     * The planned fields are filled in by startMove()/getTimeForMove(); the constructor
+     * clears them, so a segment is written {steps, rpm, accel}.
+     */
+    struct Segment {
+        steps_t steps;          // microsteps, negative to reverse
+        float rpm;              // target speed
+        short accel;            // [full steps/s^2] into and out of this segment, 0 = instant
+        // planned
+        steps_t ramp_up;        // steps accelerating at the start
+        steps_t ramp_down;      // steps decelerating at the end
+        long n_in;              // ramp step index of the entry speed
+        long n_out;             // ramp step index of the exit speed
+        long cruise_pulse;
+        long start_pulse;       // first step pulse when starting from standstill, 0 = keep going
+        long ramp_c0;           // exact first step pulse of the ramps (setExactRamps())
+        float speed_out;        // exit speed [full steps/s]
+
+        Segment(steps_t steps=0, float rpm=0, short accel=0)
+        :steps(steps), rpm(rpm), accel(accel), ramp_up(0), ramp_down(0), n_in(0), n_out(0),
+         cruise_pulse(0), start_pulse(0), ramp_c0(0), speed_out(0)
+        {};
+    };
+    /*
+     * Consistent snapshot of a running move, see getStatus()
+     */
+    struct Status {
+        steps_t steps_completed;
+        steps_t steps_remaining;
+        long step_pulse;        // current step interval (micros)
+        enum State state;
+        float rpm;              // current speed
+    };
     static inline void delayMicros(unsigned long delay_us, unsigned long start_us = 0){
         if (delay_us){
             if (!start_us){
@@ -53,9 +121,64 @@ public:
 private:
     // calculation remainder to be fed into successive steps to increase accuracy (Atmel DOC8017)
     long rest;
-    unsigned long last_action_end = 0;
+    // time the last step was due and the interval to the next one (absolute schedule)
+    unsigned long last_action_due = 0;
     unsigned long next_action_interval = 0;
 
+    /*
+     * Status snapshot published by the stepping path (seqlock).
+     * status_seq is odd while an update is in progress.
+     */
+    volatile unsigned char status_seq = 0;
+    volatile steps_t status_step_count = 0;
+    volatile steps_t status_steps_remaining = 0;
+    volatile long status_step_pulse = 0;
+    volatile steps_t status_steps_to_cruise = 0;
+    volatile steps_t status_steps_to_brake = 0;
+    volatile short status_step_size = 1;
+
+    /*
+     * Power state
+     */
+    bool enabled = false;
+    // ENABLE asserted at wake_start and the wakeup time may not have elapsed yet
+    bool waking = false;
+    unsigned long wake_start;
+    // auto power: time stopped before disabling (ms), 0 = off
+    unsigned long auto_power_timeout = 0;
+    bool idle_timing = false;
+    unsigned long idle_start;   // millis()
+    // moves started so far
+    unsigned move_count = 0;
+
+    // called from nextAction()/service() while stopped
+    void stopped(unsigned long now);
+
+    /*
+     * Emergency stop, shared by all motors
+     */
+    static volatile bool emergency;
+    static bool emergency_disable;
+    void abortMove(void);
+    // timing and power setup common to all the start methods
+    void startMotion(void);
+
+    /*
+     * Multi-segment move
+     */
+    Segment* segments = nullptr;
+    short segment_count = 0;
+    short segment_index = 0;
+    steps_t segment_end = 0;    // steps_remaining at the end of the current segment
+    bool nextSegment(void);
+
+    // absolute position at step_count 0 of the current move, in the current direction
+    steps_t position_origin = 0;
+
+    // step recording, see setRecorder()
+    StepRecorder* recorder = nullptr;
+    uint8_t recorder_flags = 0;
+
 protected:
     /*
      * Motor Configuration
@@ -83,26 +206,112 @@ protected:
     short wakeup_time = 0;
 
     float rpm = 0;
+    // speed factor applied to rpm, see setFeedOverride()
+    float feed = 1.0;
+    // shortest step interval this board can sustain, measured by calibrate() (us, 0 = not measured)
+    unsigned min_step_interval = 0;
 
     /*
      * Movement state
      */
     struct Profile profile;
 
-    long step_count;        // current position
-    long steps_remaining;   // to complete the current move (absolute value)
-    long steps_to_cruise;   // steps to reach cruising (max) rpm
-    long steps_to_brake;    // steps needed to come to a full stop
+    steps_t step_count;     // current position
+    steps_t steps_remaining;    // to complete the current move (absolute value)
+    steps_t steps_to_cruise;    // steps to reach cruising (max) rpm
+    steps_t steps_to_brake;     // steps needed to come to a full stop
     long step_pulse;        // step pulse duration (microseconds)
     long cruise_step_pulse; // step pulse duration for constant speed section (max rpm)
+    long move_step_pulse;   // cruise_step_pulse of the current move at 100% feed
+    // microsteps moved per STEP pulse, >1 while the driver interpolates a coarser input mode
+    unsigned char step_size = 1;
+    // ramp step index offsets, for ramps between non-zero speeds (multi-segment moves)
+    long accel_n = 0;
+    long decel_n = 0;
+    // exact ramp start, see setExactRamps(): first step pulse of each ramp
+    bool exact_ramps = false;
+    long accel_c0;
+    long decel_c0;
 
     // DIR pin state
     short dir_state;
 
     void calcStepPulse(void);
 
+    // state for the given position in a move with the given ramp lengths
+    static enum State calcState(steps_t step_count, steps_t steps_remaining,
+                                steps_t steps_to_cruise, steps_t steps_to_brake){
+        if (steps_remaining <= 0){
+            return STOPPED;
+        }
+        if (steps_remaining <= steps_to_brake){
+            return DECELERATING;
+        }
+        if (step_count <= steps_to_cruise){
+            return ACCELERATING;
+        }
+        return CRUISING;
+    }
+    // publish movement state for getStatus()
+    inline void publishStatus(void){
+        status_seq++;
+        STATUS_BARRIER();
+        status_step_count = step_count;
+        status_steps_remaining = steps_remaining;
+        status_step_pulse = step_pulse;
+        status_steps_to_cruise = steps_to_cruise;
+        status_steps_to_brake = steps_to_brake;
+        status_step_size = step_size;
+        STATUS_BARRIER();
+        status_seq++;
+    }
+
+    // microsteps per STEP pulse the cruise at <rpm> will use (see step_size)
+    virtual unsigned char cruiseStepSize(float){
+        return 1;
+    }
+    // rpm with the feed override, capped to what the board can step (getMaxRPM()),
+    // used when planning moves. The cap is on the STEP rate, so a cruise that moves
+    // several microsteps per STEP can go that much faster.
+    float limitRPM(float rpm){
+        rpm *= feed;
+        float max_rpm = getMaxRPM();
+        if (max_rpm > 0 && rpm > max_rpm * cruiseStepSize(rpm)){
+            float limit = max_rpm * cruiseStepSize(rpm);
+            // at the capped speed the cruise may no longer qualify for the larger steps
+            rpm = (cruiseStepSize(limit) > 1) ? limit : max_rpm;
+        }
+        return rpm;
+    }
+
     // this is internal because one can call the start methods while CRUISING to get here
-    void alterMove(long steps);
+    void alterMove(steps_t steps);
+    // calculate the profile for a new move (startMove() without the timing and power setup)
+    void calcMove(steps_t steps, move_time_t time=0);
+    // fill in the planned fields of a segment list, returns the total steps
+    steps_t planSegments(Segment* segments, short count);
+
+    // toggle STEP for one step and calculate the interval until the next one
+    void emitStep(void);
+
+    /*
+     * Movement state notifications for derived drivers, off unless notify_state is set
+     * so the step path only pays for them when used.
+     * stateChanged(state) is called before the first step in a new state, and with STOPPED
+     * right after the last step of a move; idle(now) is called from nextAction()/service()
+     * while stopped.
+     */
+    bool notify_state = false;
+    enum State notified_state = STOPPED;
+    virtual void stateChanged(enum State){};
+    virtual void idle(unsigned long){};
+    inline void checkState(void){
+        enum State state = getCurrentState();
+        if (state != notified_state){
+            notified_state = state;
+            stateChanged(state);
+        }
+    }
 
 private:
     // microstep range (1, 16, 32 etc)
@@ -136,8 +345,57 @@ public:
     float getRPM(void){
         return rpm;
     };
+    /*
+     * Scale the speed by <factor> (feed override, 0.1 - 2.0), including the move in
+     * progress (see changeSpeed()). Moves started later run at rpm * factor;
+     * moves in progress that cannot change speed (see canChangeSpeed()) keep theirs.
+     */
+    void setFeedOverride(float factor);
+    float getFeedOverride(void){
+        return feed;
+    }
+    /*
+     * Change the cruise speed of the move in progress to <rpm>. A LINEAR_SPEED move
+     * accelerates or decelerates to it, with its acceleration times <accel_scale> and
+     * its deceleration times <decel_scale> for the rest of the move; a CONSTANT_SPEED
+     * move changes speed at the next step.
+     * Call between steps. Does nothing unless canChangeSpeed().
+     */
+    void changeSpeed(float rpm, float accel_scale=1.0, float decel_scale=1.0);
+    /*
+     * True if the move in progress can change speed: not multi-segment, not braking to
+     * its end, and not cruising on interpolated steps (TMC2100, more than one microstep
+     * per STEP)
+     */
+    bool canChangeSpeed(void){
+        return steps_remaining > 0 && !segments && step_size == 1 &&
+            !(profile.mode == LINEAR_SPEED && getCurrentState() == DECELERATING && !segment_end);
+    }
+    /*
+     * Cruise speed of the move in progress
+     */
+    float getCruiseRPM(void){
+        return 60.0*1000000L / cruise_step_pulse / microsteps / motor_steps;
+    }
+    /*
+     * Measure the time this board spends per step (profile calculation, pin writes and
+     * minimum pulse widths) and limit the speed of all following moves to what it can
+     * sustain, so that they run in the time getTimeForMove() predicts.
+     * Call while stopped, after begin() and setMinStepPulse(); the motor does not move.
+     * Returns the shortest step interval in microseconds.
+     * This is the cost of one motor stepping alone; a MultiDriver or SyncDriver adds its
+     * own scheduling work per step, which is not included.
+     */
+    unsigned calibrate(void);
+    /*
+     * Max RPM at the current microstep level as measured by calibrate(), 0 if not calibrated.
+     * Moves at a higher RPM setting run at this speed instead.
+     */
+    float getMaxRPM(void){
+        return min_step_interval ? 60.0*1000000L / min_step_interval / microsteps / motor_steps : 0;
+    }
     float getCurrentRPM(void){
-        return (60.0*1000000L / step_pulse / microsteps / motor_steps);
+        return (60.0*1000000L * step_size / step_pulse / microsteps / motor_steps);
     }
     /*
      * Set minimum STEP pulse HIGH and LOW durations (microseconds).
@@ -170,11 +428,27 @@ public:
     short getDeceleration(void){
         return profile.decel;
     }
+    /*
+     * Time the first 16 steps of every acceleration and deceleration ramp from a table
+     * of the exact constant acceleration intervals, instead of the fast approximation
+     * which needs a 0.676 correction of the first step (a speed spike right at the
+     * start) to end up close. The approximation takes over from the exact value; in
+     * moves that reach cruise speed all ramp steps of 100us or more then stay within
+     * 2% of ideal (measured), so higher accelerations can be used without stalling.
+     * Applies to LINEAR_SPEED and multi-segment moves started afterwards.
+     */
+    void setExactRamps(bool exact){
+        exact_ramps = exact;
+    }
     /*
      * Move the motor a given number of steps.
      * positive to move forward, negative to reverse
      */
-    void move(long steps);
+    void move(steps_t steps);
+    /*
+     * Move through a list of velocity segments without stopping in between
+     */
+    void move(Segment* segments, short count);
     /*
      * Rotate the motor a given number of degrees (1-360)
      */
@@ -196,6 +470,54 @@ public:
      */
     virtual void enable(void);
     virtual void disable(void);
+    /*
+     * Turn on the motor without waiting for the driver to wake up.
+     * Returns the time (micros) to wait before stepping. A move started meanwhile
+     * delays its first step by the remaining time instead of waiting in enable().
+     */
+    short startEnable(void);
+    /*
+     * Turn the motor back on if auto power turned it off, without waiting, and restart
+     * the idle time. Returns the time (micros) left before it can step, 0 if ready.
+     */
+    short wake(void);
+    bool isEnabled(void){
+        return enabled;
+    }
+    /*
+     * Emergency stop for all motors, safe to call from an interrupt handler.
+     * Every motor checks it right before raising STEP, so none emits another step once
+     * it is set, whatever the caller is doing; moves are aborted (no deceleration) and,
+     * if requested, each motor disables itself when it notices. Moves started while it
+     * is set do not run, until clearEmergencyStop().
+     */
+    static void emergencyStop(bool disable=false){
+        emergency_disable = disable;
+        emergency = true;
+    }
+    static void clearEmergencyStop(void){
+        emergency = false;
+    }
+    static bool isEmergencyStopped(void){
+        return emergency;
+    }
+    /*
+     * Record every step of this motor (moves and single steps) as motor <id> (0-7),
+     * nullptr to stop recording. Several motors can share one recorder.
+     */
+    void setRecorder(StepRecorder* recorder, uint8_t id=0){
+        recorder_flags = (id << STEP_RECORDER_ID_SHIFT) & STEP_RECORDER_ID_MASK;
+        this->recorder = recorder;
+    }
+    /*
+     * Automatic power: disable the motor once it has been stopped for <idle_time> ms,
+     * and enable it again at the next startMove() without blocking (the first step is
+     * scheduled after the driver wakeup time). 0 turns it off.
+     * The idle time is checked by nextAction()/service() calls made while stopped.
+     */
+    void setAutoPower(unsigned long idle_time){
+        auto_power_timeout = idle_time;
+    }
     /*
      * Methods for non-blocking mode.
      * They use more code but allow doing other operations between impulses.
@@ -208,7 +530,39 @@ public:
      * If time (microseconds) is given, the driver will attempt to execute the move in exactly that time
      * by altering rpm for this move only (up to preset rpm).
      */
-    void startMove(long steps, long time=0);
+    void startMove(steps_t steps, move_time_t time=0);
+    /*
+     * Initiate a move made of several velocity segments (e.g. fast approach, slow
+     * dispense, fast retract), run as one move. The list is used in place and must
+     * stay valid until the move completes. Requires no speed profile (each segment
+     * has its own acceleration) and is run with the linear speed recurrence.
+     */
+    void startMove(Segment* segments, short count);
+    /*
+     * Emit a single step right away in the given direction (1 forward, -1 back),
+     * independent of any move. Used to follow another motor, see MultiDriver::setGear().
+     * A motor turned off by auto power is turned on first, waiting for it to wake up.
+     */
+    void step(int direction);
+    /*
+     * Non-blocking alternative to step(): add <steps> single steps (negative to reverse)
+     * to the ones still pending, fired back to back by service()/nextAction() without a
+     * speed profile. Steps the other way cancel pending ones first. Also wakes a motor
+     * turned off by auto power, scheduling the first step after the wakeup time.
+     */
+    void queueSteps(steps_t steps);
+    /*
+     * Number of moves started, to tell a new move from the one in progress
+     */
+    unsigned getMoveCount(void){
+        return move_count;
+    }
+    /*
+     * Advance the move's speed profile by one step without pulsing STEP and return
+     * the interval to the next step (micros), 0 once the move is complete.
+     * Lets the profile time steps generated elsewhere (SyncDriver arcs).
+     */
+    long nextProfileStep(void);
     inline void startRotate(int deg){
         startRotate((long)deg);
     };
@@ -218,6 +572,16 @@ public:
      * Toggle step at the right time and return time until next change is needed (micros)
      */
     long nextAction(void);
+    /*
+     * Polling alternative to nextAction() which never waits for the next step.
+     * Fires the step only if it is due at time <now> (micros()) and returns immediately otherwise.
+     * Returns true while the move is in progress, false when it is complete.
+     */
+    bool service(unsigned long now);
+    /*
+     * Return time left until the next step is due at time <now> (micros), 0 if due or stopped
+     */
+    unsigned long getTimeToNextAction(unsigned long now);
     /*
      * Optionally, call this to begin braking (and then stop) early
      * For constant speed, this is the same as stop()
@@ -227,7 +591,7 @@ public:
      * Immediate stop
      * Returns the number of steps remaining.
      */
-    long stop(void);
+    steps_t stop(void);
     /*
      * State querying
      */
@@ -236,16 +600,31 @@ public:
      * Get the number of completed steps so far.
      * This is always a positive number
      */
-    long getStepsCompleted(void){
+    steps_t getStepsCompleted(void){
         return step_count;
     }
     /*
      * Get the number of steps remaining to complete the move
      * This is always a positive number
      */
-    long getStepsRemaining(void){
+    steps_t getStepsRemaining(void){
         return steps_remaining;
     }
+    /*
+     * Get a consistent snapshot of the move progress, speed and state.
+     * Unlike the individual getters above, this is safe to call at any rate while the
+     * steps are generated from an interrupt or another task, and never blocks stepping.
+     */
+    struct Status getStatus(void);
+    /*
+     * Absolute position (microsteps), counting all moves since begin() or setPosition()
+     */
+    steps_t getPosition(void){
+        return position_origin + ((dir_state == HIGH) ? step_count : -step_count);
+    }
+    void setPosition(steps_t position){
+        position_origin += position - getPosition();
+    }
     /*
      * Get movement direction: forward +1, back -1
      */
@@ -254,15 +633,19 @@ public:
     }
     /*
      * Return calculated time to complete the given move
+     * (saturates at MOVE_TIME_MAX micros)
      */
-    long getTimeForMove(long steps);
+    move_time_t getTimeForMove(steps_t steps);
+    move_time_t getTimeForMove(Segment* segments, short count);
     /*
      * Calculate steps needed to rotate requested angle, given in degrees
      */
-    long calcStepsForRotation(long deg){
-        return deg * motor_steps * (long)microsteps / 360;
+    steps_t calcStepsForRotation(long deg){
+        // whole turns first, so many turns do not overflow the intermediate product
+        steps_t steps_per_rev = (steps_t)motor_steps * microsteps;
+        return deg / 360 * steps_per_rev + deg % 360 * steps_per_rev / 360;
     }
-    long calcStepsForRotation(double deg){
+    steps_t calcStepsForRotation(double deg){
         return deg * motor_steps * microsteps / 360;
     }
 };
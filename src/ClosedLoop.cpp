@@ -0,0 +1,77 @@
+/*
+ * Encoder feedback for a stepper motor: following error, stall detection and correction
+ *
+ * Copyright (C)2026 Laurentiu Badea
+ *
+ * This file may be redistributed under the terms of the MIT license.
+ * A copy of this license has been included with this distribution in the file LICENSE.
+ */
+#include "ClosedLoop.h"
+
+void ClosedLoop::begin(void){
+    short microsteps = motor.getMicrostep();
+    steps_per_count = (float)motor.getSteps() * microsteps / counts_per_rev;
+    tolerance = microsteps;
+    max_error = 4 * microsteps;
+    encoder.write(0);
+    offset = motor.getPosition();
+}
+
+steps_t ClosedLoop::getActualPosition(void){
+    return offset + lround(encoder.read() * steps_per_count);
+}
+
+void ClosedLoop::startMove(steps_t steps){
+    target = motor.getPosition() + steps;
+    corrections = 0;
+    last_check = 0;
+    max_seen_error = 0;
+    stalled = false;
+    motor.startMove(steps);
+}
+
+void ClosedLoop::move(steps_t steps){
+    startMove(steps);
+    while (service(micros()));
+}
+
+bool ClosedLoop::service(unsigned long now){
+    encoder.poll();
+    bool running = motor.service(now);
+    if (running && absSteps(motor.getStepsCompleted() - last_check) < check_steps){
+        return true;
+    }
+    last_check = motor.getStepsCompleted();
+    check(running);
+    if (running || stalled){
+        return running && !stalled;
+    }
+    // move done: make up lost steps
+    steps_t actual = getActualPosition();
+    if (correct && absSteps(target - actual) > tolerance && corrections < max_corrections){
+        corrections++;
+        motor.setPosition(actual);
+        motor.startMove(target - actual);
+        last_check = 0;
+        return true;
+    }
+    return false;
+}
+
+/*
+ * Compare the commanded and the encoder position
+ */
+void ClosedLoop::check(bool running){
+    error = motor.getPosition() - getActualPosition();
+    if (absSteps(error) > max_seen_error){
+        max_seen_error = absSteps(error);
+    }
+    if (absSteps(error) > max_error){
+        stalled = true;
+        if (running){
+            motor.stop();
+        }
+        // keep the position true to the encoder
+        motor.setPosition(getActualPosition());
+    }
+}
@@ -0,0 +1,104 @@
+/*
+ * Encoder feedback for a stepper motor: following error, stall detection and correction
+ *
+ * Copyright (C)2026 Laurentiu Badea
+ *
+ * This file may be redistributed under the terms of the MIT license.
+ * A copy of this license has been included with this distribution in the file LICENSE.
+ */
+#ifndef CLOSED_LOOP_H
+#define CLOSED_LOOP_H
+#include <Arduino.h>
+#include "BasicStepperDriver.h"
+#include "QuadratureEncoder.h"
+
+/*
+ * Closed loop class.
+ * Runs a motor's moves (non-blocking, like the motor's own service()) and every few
+ * steps compares its commanded position with the encoder:
+ *  - the following error (commanded - actual, in microsteps) is reported
+ *  - beyond max_error the motor is taken as stalled and the move aborted
+ *  - steps lost without stalling are made up with a correction move at the end
+ * The checks run between steps, outside of the motor's step timing.
+ */
+class ClosedLoop {
+protected:
+    BasicStepperDriver& motor;
+    QuadratureEncoder& encoder;
+    long counts_per_rev;
+    // microsteps per encoder count (motor steps * microsteps / counts_per_rev)
+    float steps_per_count;
+    // motor position at encoder count 0
+    steps_t offset = 0;
+    short check_steps = 16;
+    steps_t tolerance;
+    steps_t max_error;
+    bool correct = true;
+    short max_corrections = 2;
+
+    /*
+     * Move state
+     */
+    steps_t target = 0;
+    steps_t last_check = 0;
+    short corrections;
+    steps_t error = 0;
+    steps_t max_seen_error = 0;
+    bool stalled = false;
+
+    void check(bool running);
+    static steps_t absSteps(steps_t steps){
+        return (steps >= 0) ? steps : -steps;
+    }
+
+public:
+    ClosedLoop(BasicStepperDriver& motor, QuadratureEncoder& encoder, long counts_per_rev)
+    :motor(motor), encoder(encoder), counts_per_rev(counts_per_rev)
+    {};
+    /*
+     * Call after the motor's begin(); the current motor position is taken as matching the
+     * encoder. Tolerance defaults to 1 full step, max error (stall) to 4 full steps.
+     */
+    void begin(void);
+    /*
+     * Check every <check_steps> steps (1 = each step).
+     * Errors of up to <tolerance> microsteps are accepted at the end of a move; more
+     * than <max_error> at any time aborts the move as a stall.
+     */
+    void setLimits(steps_t tolerance, steps_t max_error, short check_steps=16){
+        this->tolerance = tolerance;
+        this->max_error = max_error;
+        this->check_steps = check_steps;
+    }
+    /*
+     * Make up lost steps at the end of a move, up to max_corrections extra moves
+     */
+    void setCorrection(bool correct, short max_corrections=2){
+        this->correct = correct;
+        this->max_corrections = max_corrections;
+    }
+    void startMove(steps_t steps);
+    void move(steps_t steps);
+    /*
+     * Step the motor and check the encoder; returns true while the move (or its
+     * correction) is in progress
+     */
+    bool service(unsigned long now);
+    /*
+     * Encoder position in motor microsteps
+     */
+    steps_t getActualPosition(void);
+    /*
+     * Following error (microsteps) at the last check, and the largest one of the move
+     */
+    steps_t getFollowingError(void){
+        return error;
+    }
+    steps_t getMaxFollowingError(void){
+        return max_seen_error;
+    }
+    bool isStalled(void){
+        return stalled;
+    }
+};
+#endif // CLOSED_LOOP_H
@@ -9,6 +9,23 @@
  */
 #include "DRV8834.h"
 
+/*
+ * Step mode truth table
+ * M1 M0    step mode
+ *  0  0     1
+ *  0  1     2
+ *  0  Z     4
+ *  1  0     8
+ *  1  1    16
+ *  1  Z    32
+ *
+ *  Z = high impedance mode (M0 is tri-state)
+ * {0bM1,M0 levels, 0bM1,M0 driven} for 1,2,4,8,16,32 microsteps
+ */
+const PinGroup::State DRV8834::MS_TABLE[] = {
+    {0b00, 0b11}, {0b01, 0b11}, {0b00, 0b10}, {0b10, 0b11}, {0b11, 0b11}, {0b10, 0b10}
+};
+
 /*
  * Basic connection: only DIR, STEP are connected.
  * Microstepping controls should be hardwired.
@@ -32,6 +49,17 @@ DRV8834::DRV8834(short steps, short dir_pin, short step_pin, short enable_pin, s
 :BasicStepperDriver(steps, dir_pin, step_pin, enable_pin), m0_pin(m0_pin), m1_pin(m1_pin)
 { initTiming(); }
 
+void DRV8834::begin(float rpm, short microsteps){
+    // precompute the Mx pin states so setMicrostep() changes all pins at once
+    ms_pins.begin(m0_pin, m1_pin);
+    if (ms_pins.isConnected()){
+        for (size_t i = 0; i < sizeof(MS_TABLE)/sizeof(*MS_TABLE); i++){
+            ms_states[i] = ms_pins.prepare(MS_TABLE[i].value, MS_TABLE[i].drive);
+        }
+    }
+    BasicStepperDriver::begin(rpm, microsteps);
+}
+
 /*
  * Set microstepping mode (1:divisor)
  * Allowed ranges for DRV8834 are 1:1 to 1:32
@@ -41,41 +69,15 @@ DRV8834::DRV8834(short steps, short dir_pin, short step_pin, short enable_pin, s
 short DRV8834::setMicrostep(short microsteps){
     BasicStepperDriver::setMicrostep(microsteps);
 
-    if (!IS_CONNECTED(m0_pin) || !IS_CONNECTED(m1_pin)){
+    if (!ms_pins.isConnected()){
         return this->microsteps;
     }
 
-    /*
-     * Step mode truth table
-     * M1 M0    step mode
-     *  0  0     1
-     *  0  1     2
-     *  0  Z     4
-     *  1  0     8
-     *  1  1    16
-     *  1  Z    32
-     *
-     *  Z = high impedance mode (M0 is tri-state)
-     */
-
-    pinMode(m1_pin, OUTPUT);
-    digitalWrite(m1_pin, (this->microsteps < 8) ? LOW : HIGH);
-
-    switch(this->microsteps){
-    case 1:
-    case 8:
-        pinMode(m0_pin, OUTPUT);
-        digitalWrite(m0_pin, LOW);
-        break;
-    case 2:
-    case 16:
-        pinMode(m0_pin, OUTPUT);
-        digitalWrite(m0_pin, HIGH);
-        break;
-    case 4:
-    case 32:
-        pinMode(m0_pin, INPUT); // Z - high impedance
-        break;
+    for (size_t i = 0; i < sizeof(MS_TABLE)/sizeof(*MS_TABLE); i++){
+        if (this->microsteps & (1<<i)){
+            ms_pins.apply(ms_states[i]);
+            break;
+        }
     }
     return this->microsteps;
 }
@@ -11,11 +11,16 @@
 #define DRV8834_H
 #include <Arduino.h>
 #include "BasicStepperDriver.h"
+#include "PinGroup.h"
 
 class DRV8834 : public BasicStepperDriver {
 protected:
     short m0_pin = PIN_UNCONNECTED;
     short m1_pin = PIN_UNCONNECTED;
+    static const PinGroup::State MS_TABLE[];
+    // M0, M1 pins and their precomputed states for each microstep level
+    PinGroup ms_pins;
+    PinGroup::State ms_states[PIN_GROUP_MAX_STATES];
     // Set timing requirements from DRV8834 datasheet
     void initTiming(){
         // tWH(STEP) pulse duration, STEP high, min value (1.9us)
@@ -46,6 +51,7 @@ public:
      */
     DRV8834(short steps, short dir_pin, short step_pin, short m0_pin, short m1_pin);
     DRV8834(short steps, short dir_pin, short step_pin, short enable_pin, short m0_pin, short m1_pin);
+    void begin(float rpm=60, short microsteps=1) override;
     short setMicrostep(short microsteps) override;
 };
 #endif // DRV8834_H
@@ -8,6 +8,23 @@
  */
 #include "DRV8880.h"
 
+/*
+ * Step mode truth table
+ * M1 M0    step mode
+ *  0  0     1
+ *  1  0     2
+ *  1  1     4
+ *  0  Z     8
+ *  1  Z    16
+ *
+ *  0  1     2 (non-circular, not implemented)
+ *  Z = high impedance mode (M0 is tri-state)
+ * {0bM1,M0 levels, 0bM1,M0 driven} for 1,2,4,8,16 microsteps
+ */
+const PinGroup::State DRV8880::MS_TABLE[] = {
+    {0b00, 0b11}, {0b10, 0b11}, {0b11, 0b11}, {0b00, 0b10}, {0b10, 0b10}
+};
+
 /*
  * Basic connection: only DIR, STEP are connected.
  * Microstepping controls should be hardwired.
@@ -40,8 +57,22 @@ DRV8880::DRV8880(short steps, short dir_pin, short step_pin, short enable_pin, s
 { initTiming(); }
 
 void DRV8880::begin(float rpm, short microsteps){
+    // precompute the Mx pin states so setMicrostep() changes all pins at once
+    ms_pins.begin(m0, m1);
+    if (ms_pins.isConnected()){
+        for (size_t i = 0; i < sizeof(MS_TABLE)/sizeof(*MS_TABLE); i++){
+            ms_states[i] = ms_pins.prepare(MS_TABLE[i].value, MS_TABLE[i].drive);
+        }
+    }
+    // same for the TRQ pins and setCurrent()
+    trq_pins.begin(trq0, trq1);
+    if (trq_pins.isConnected()){
+        for (uint8_t i = 0; i < 4; i++){
+            trq_states[i] = trq_pins.prepare(i);
+        }
+    }
     BasicStepperDriver::begin(rpm, microsteps);
-    setCurrent(100);
+    setCurrent(current_policy.hold);
 }
 
 short DRV8880::getMaxMicrostep(){
@@ -56,46 +87,15 @@ short DRV8880::getMaxMicrostep(){
 short DRV8880::setMicrostep(short microsteps){
     BasicStepperDriver::setMicrostep(microsteps);
 
-    if (!IS_CONNECTED(m0) || !IS_CONNECTED(m1)){
+    if (!ms_pins.isConnected()){
         return this->microsteps;
     }
 
-    /*
-     * Step mode truth table
-     * M1 M0    step mode
-     *  0  0     1
-     *  1  0     2
-     *  1  1     4
-     *  0  Z     8
-     *  1  Z    16
-     *
-     *  0  1     2 (non-circular, not implemented)
-     *  Z = high impedance mode (M0 is tri-state)
-     */
-
-    pinMode(m1, OUTPUT);
-    pinMode(m0, OUTPUT);
-    switch(this->microsteps){
-        case 1:
-            digitalWrite(m1, LOW);
-            digitalWrite(m0, LOW);
-            break;
-        case 2:
-            digitalWrite(m1, HIGH);
-            digitalWrite(m0, LOW);
-            break;
-        case 4:
-            digitalWrite(m1, HIGH);
-            digitalWrite(m0, HIGH);
-            break;
-        case 8:
-            digitalWrite(m1, LOW);
-            pinMode(m0, INPUT); // Z - high impedance
-            break;
-        case 16:
-            digitalWrite(m1, HIGH);
-            pinMode(m0, INPUT); // Z - high impedance
+    for (size_t i = 0; i < sizeof(MS_TABLE)/sizeof(*MS_TABLE); i++){
+        if (this->microsteps & (1<<i)){
+            ms_pins.apply(ms_states[i]);
             break;
+        }
     }
     return this->microsteps;
 }
@@ -109,13 +109,48 @@ void DRV8880::setCurrent(short percent){
      *  0     1       75%
      *  0     0      100%
      */
-    if (!IS_CONNECTED(trq1) || !IS_CONNECTED(trq0)){
+    if (!trq_pins.isConnected()){
         return;
     }
-    pinMode(trq1, OUTPUT);
-    pinMode(trq0, OUTPUT);
     percent = (100-percent)/25;
-    digitalWrite(trq1, percent & 2);
-    digitalWrite(trq0, percent & 1);
+    trq_pins.apply(trq_states[(percent < 0) ? 0 : (percent > 3) ? 3 : percent]);
+}
+
+void DRV8880::setCurrentPolicy(struct CurrentPolicy policy){
+    current_policy = policy;
+    notify_state = true;
 }
 
+/*
+ * Apply the current policy level for the new state.
+ * When stopped, keep the current until the hold timeout expires, counting from the
+ * last step of the move.
+ */
+void DRV8880::stateChanged(enum State state){
+    hold_pending = false;
+    switch (state){
+    case ACCELERATING:
+        setCurrent(current_policy.accel);
+        break;
+    case CRUISING:
+        setCurrent(current_policy.cruise);
+        break;
+    case DECELERATING:
+        setCurrent(current_policy.decel);
+        break;
+    case STOPPED:
+        stopped_time = micros();
+        hold_pending = true;
+        // without a timeout, switch now instead of waiting for the caller to poll
+        idle(stopped_time);
+        break;
+    }
+}
+
+void DRV8880::idle(unsigned long now){
+    // signed difference, <now> may have been sampled by the caller just before stopped_time
+    if (hold_pending && (long)(now - stopped_time) >= (long)(current_policy.hold_timeout * 1000UL)){
+        setCurrent(current_policy.hold);
+        hold_pending = false;
+    }
+}
@@ -10,6 +10,7 @@
 #define DRV8880_H
 #include <Arduino.h>
 #include "BasicStepperDriver.h"
+#include "PinGroup.h"
 
 class DRV8880 : public BasicStepperDriver {
 protected:
@@ -17,6 +18,13 @@ protected:
     short m1 = PIN_UNCONNECTED;
     short trq0 = PIN_UNCONNECTED;
     short trq1 = PIN_UNCONNECTED;
+    static const PinGroup::State MS_TABLE[];
+    // M0, M1 pins and their precomputed states for each microstep level
+    PinGroup ms_pins;
+    PinGroup::State ms_states[PIN_GROUP_MAX_STATES];
+    // TRQ0, TRQ1 pins and their precomputed states for 100, 75, 50, 25%
+    PinGroup trq_pins;
+    PinGroup::State trq_states[4];
     // Set timing requirements from DRV8880 datasheet
     void initTiming(){
         // tWH(STEP) pulse duration, STEP high, min value (0.47us -> 1;
@@ -35,10 +43,32 @@ protected:
     // Get max microsteps supported by the device
     short getMaxMicrostep() override;
 
+    // apply the current policy as the move progresses
+    void stateChanged(enum State state) override;
+    void idle(unsigned long now) override;
+    // waiting to switch to hold current
+    bool hold_pending = false;
+    unsigned long stopped_time;
+
 private:
     // microstep range (1, 16, 32 etc)
     static const short MAX_MICROSTEP = 16;
 
+public:
+    /*
+     * Torque DAC level (percent) to use in each movement state
+     */
+    struct CurrentPolicy {
+        short accel = 100;
+        short cruise = 100;
+        short decel = 100;
+        short hold = 100;               // when stopped
+        unsigned long hold_timeout = 0; // time from the last step to switching to hold current [ms]
+    };
+
+protected:
+    struct CurrentPolicy current_policy;
+
 public:
     /*
      * Basic connection: only DIR, STEP are connected.
@@ -66,5 +96,17 @@ public:
      * current percent value must be 25, 50, 75 or 100.
      */
     void setCurrent(short percent=100);
+    /*
+     * Change the current automatically as the move progresses, for example to reduce
+     * heating while cruising or holding and have full torque for acceleration.
+     * Values as for setCurrent(). Requires the TRQ pins to be connected.
+     * The hold current is set with the last step of a move if hold_timeout is 0;
+     * otherwise by the first nextAction()/service() call (of the motor or its group)
+     * after the timeout.
+     */
+    void setCurrentPolicy(struct CurrentPolicy policy);
+    struct CurrentPolicy getCurrentPolicy(void){
+        return current_policy;
+    }
 };
 #endif // DRV8880_H
@@ -0,0 +1,269 @@
+/*
+ * Streaming G-code interpreter for a motor group
+ *
+ * Copyright (C)2026 Laurentiu Badea
+ *
+ * This file may be redistributed under the terms of the MIT license.
+ * A copy of this license has been included with this distribution in the file LICENSE.
+ */
+#include "GCodeInterpreter.h"
+
+#define FOREACH_AXIS(action) for (short i=0; i < 3; i++){action;}
+
+/*
+ * Reset the per-line parser state
+ */
+void GCodeInterpreter::startLine(void){
+    parse_state = LINE_START;
+    g_code = -1;
+    FOREACH_AXIS(has_axis[i] = false);
+    p_word = 0;
+    s_word = 0;
+}
+
+/*
+ * Process one input character
+ */
+bool GCodeInterpreter::feed(char c){
+    if (c == '\n' || c == '\r'){
+        // unterminated comments also end here
+        endWord();
+        if (!endLine()){
+            return false;
+        }
+        startLine();
+        return true;
+    }
+    switch (parse_state){
+    case COMMENT:
+        if (c == ')'){
+            parse_state = WORD;
+        }
+        return true;
+    case LINE_COMMENT:
+        return true;
+    case NUMBER:
+        if (c >= '0' && c <= '9'){
+            // digits beyond 9 significant ones are dropped
+            if (mantissa < 100000000L){
+                mantissa = mantissa * 10 + (c - '0');
+                if (decimals >= 0){
+                    decimals++;
+                }
+            }
+            return true;
+        }
+        if (c == '.' && decimals < 0){
+            decimals = 0;
+            return true;
+        }
+        if ((c == '-' || c == '+') && !mantissa && decimals < 0){
+            negative = (c == '-');
+            return true;
+        }
+        break;
+    default:
+        break;
+    }
+    // anything else ends the current word
+    endWord();
+    if (c == '('){
+        parse_state = COMMENT;
+    } else if (c == ';'){
+        parse_state = LINE_COMMENT;
+    } else {
+        if (c >= 'a' && c <= 'z'){
+            c -= 'a' - 'A';
+        }
+        if (c >= 'A' && c <= 'Z'){
+            letter = c;
+            negative = false;
+            mantissa = 0;
+            decimals = -1;
+            parse_state = NUMBER;
+        }
+    }
+    return true;
+}
+
+/*
+ * Convert the number just read and store the word
+ */
+void GCodeInterpreter::endWord(void){
+    if (parse_state != NUMBER){
+        return;
+    }
+    parse_state = WORD;
+    float value = mantissa;
+    for (signed char d = decimals; d > 0; d--){
+        value /= 10;
+    }
+    if (negative){
+        value = -value;
+    }
+    switch (letter){
+    case 'G':
+        g_code = (short)value;
+        break;
+    case 'X':
+    case 'Y':
+    case 'Z':
+        {
+            short i = (letter == 'Z') ? 2 : letter - 'X';
+            // no motor for this axis
+            if (i >= group.getCount()){
+                break;
+            }
+            has_axis[i] = true;
+            axis[i] = value;
+        }
+        break;
+    case 'F':
+        feed_rate = value;
+        break;
+    case 'P':
+        p_word = value;
+        break;
+    case 'S':
+        s_word = value;
+        break;
+    default:
+        break;  // N, M, T etc. are ignored
+    }
+}
+
+/*
+ * Execute the line just read.
+ * Returns false, leaving the parser state unchanged, if the move queue is full.
+ */
+bool GCodeInterpreter::endLine(void){
+    short code = g_code;
+    if (code == -1 && (has_axis[0] || has_axis[1] || has_axis[2])){
+        code = motion_mode;
+    }
+    switch (code){
+    case 0:
+    case 1:
+        {
+            Command move = {(code == 0) ? RAPID : MOVE, {0, 0, 0}, feed_rate, 0};
+            bool any = false;
+            FOREACH_AXIS(
+                if (has_axis[i]){
+                    steps_t target = round(axis[i] * steps_per_unit[i]);
+                    move.steps[i] = (relative) ? target : target - position[i];
+                    any |= (move.steps[i] != 0);
+                }
+            );
+            if (any){
+                if (!queueCommand(move)){
+                    return false;
+                }
+                FOREACH_AXIS(position[i] += move.steps[i]);
+            }
+            motion_mode = code;
+        }
+        break;
+    case 4:
+        {
+            // P is milliseconds, S seconds
+            long time = lround(p_word + s_word * 1000);
+            Command dwell = {DWELL, {0, 0, 0}, 0, (unsigned long)time};
+            if (time > 0 && !queueCommand(dwell)){
+                return false;
+            }
+        }
+        break;
+    case 90:
+        relative = false;
+        break;
+    case 91:
+        relative = true;
+        break;
+    case 92:
+        FOREACH_AXIS(
+            if (has_axis[i]){
+                position[i] = round(axis[i] * steps_per_unit[i]);
+            }
+        );
+        break;
+    default:
+        break;  // not supported, ignored
+    }
+    return true;
+}
+
+bool GCodeInterpreter::queueCommand(const Command& command){
+    if (queue_count == GCODE_QUEUE_SIZE){
+        return false;
+    }
+    queue[(queue_head + queue_count) % GCODE_QUEUE_SIZE] = command;
+    queue_count++;
+    return true;
+}
+
+void GCodeInterpreter::process(Stream& input){
+    while (input.available()){
+        if (!feed(input.peek())){
+            break;
+        }
+        input.read();
+    }
+}
+
+/*
+ * Start the next move when the previous one completes, and step the current one
+ */
+bool GCodeInterpreter::service(unsigned long now){
+    if (dwell_time){
+        if (now - dwell_start < dwell_time){
+            return true;
+        }
+        dwell_time = 0;
+    }
+    if (group.service(now)){
+        return true;
+    }
+    if (!queue_count){
+        return false;
+    }
+    startCommand(queue[queue_head], now);
+    queue_head = (queue_head + 1) % GCODE_QUEUE_SIZE;
+    queue_count--;
+    return true;
+}
+
+/*
+ * Set up motor speeds for the move and start it.
+ * This is done between moves so the float math stays out of the stepping path.
+ */
+void GCodeInterpreter::startCommand(const Command& command, unsigned long now){
+    short count = group.getCount();
+    if (command.type == DWELL){
+        dwell_start = now;
+        dwell_time = command.dwell * 1000UL;
+        return;
+    }
+    if (command.type == MOVE && command.feed > 0){
+        // time to travel the path length at the feed rate [min]
+        float length = 0;
+        FOREACH_AXIS(
+            float d = command.steps[i] / steps_per_unit[i];
+            length += d * d;
+        );
+        float minutes = sqrt(length) / command.feed;
+        // give each axis the speed that covers its distance in that time
+        for (short i=0; i < count; i++){
+            if (command.steps[i]){
+                Motor& motor = group.getMotor(i);
+                float revolutions = fabs((float)command.steps[i]) / ((float)motor.getSteps() * motor.getMicrostep());
+                motor.setRPM(revolutions / minutes);
+            }
+        }
+    } else {
+        // G0, or G1 before any F word
+        for (short i=0; i < count; i++){
+            group.getMotor(i).setRPM(rapid_rpm);
+        }
+    }
+    group.startMove(command.steps[0], command.steps[1], command.steps[2]);
+}
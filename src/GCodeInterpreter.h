@@ -0,0 +1,127 @@
+/*
+ * Streaming G-code interpreter for a motor group
+ * Supports G0, G1, G4, G90, G91, G92 with X, Y, Z, F, P, S words.
+ *
+ * Copyright (C)2026 Laurentiu Badea
+ *
+ * This file may be redistributed under the terms of the MIT license.
+ * A copy of this license has been included with this distribution in the file LICENSE.
+ */
+#ifndef GCODE_INTERPRETER_H
+#define GCODE_INTERPRETER_H
+#include <Arduino.h>
+#include "MultiDriver.h"
+
+// number of parsed moves buffered ahead of the one in progress
+#ifndef GCODE_QUEUE_SIZE
+#define GCODE_QUEUE_SIZE 8
+#endif
+
+/*
+ * G-code interpreter class.
+ * Input is tokenized one character at a time (no line buffer) and complete lines are
+ * converted to moves in a queue, which service() feeds to the group without blocking,
+ * so parsing the next lines overlaps with the motion.
+ * Axes X, Y, Z map to the group's motors 0, 1, 2. Words for axes the group has no
+ * motor for (Z on a 2-motor group) are ignored and do not change the position.
+ */
+class GCodeInterpreter {
+public:
+    enum CommandType {MOVE, RAPID, DWELL};
+    struct Command {
+        CommandType type;
+        steps_t steps[3];   // relative move in steps
+        float feed;         // feed rate [units/min] for MOVE
+        unsigned long dwell;    // time [ms] for DWELL
+    };
+
+protected:
+    MultiDriver& group;
+    /*
+     * Configuration
+     */
+    float steps_per_unit[3] = {1, 1, 1};
+    float rapid_rpm = 60;
+    /*
+     * Parser state, for the line being read
+     */
+    enum ParseState {LINE_START, WORD, NUMBER, COMMENT, LINE_COMMENT};
+    ParseState parse_state = LINE_START;
+    char letter;            // current word letter
+    bool negative;          // current number sign
+    long mantissa;          // current number digits
+    signed char decimals;   // digits after the decimal point, -1 before it
+    short g_code;           // G word on this line, -1 if none
+    bool has_axis[3];
+    float axis[3];
+    float p_word, s_word;
+    /*
+     * Modal state
+     */
+    bool relative = false;  // G91
+    short motion_mode = 0;  // last G0/G1, for lines with only axis words
+    float feed_rate = 0;    // F, units/min
+    steps_t position[3] = {0, 0, 0};    // planned position in steps, once all queued moves are done
+    /*
+     * Move queue (ring buffer)
+     */
+    Command queue[GCODE_QUEUE_SIZE];
+    unsigned char queue_head = 0;
+    unsigned char queue_count = 0;
+    // DWELL in progress
+    unsigned long dwell_start;
+    unsigned long dwell_time = 0;
+
+    void startLine(void);
+    void endWord(void);
+    bool endLine(void);
+    bool queueCommand(const Command& command);
+    void startCommand(const Command& command, unsigned long now);
+
+public:
+    GCodeInterpreter(MultiDriver& group)
+    :group(group)
+    { startLine(); };
+    /*
+     * Set the steps (at the motor's microstep level) per unit (mm, inch...) for each axis
+     */
+    void setStepsPerUnit(float x, float y, float z=1){
+        steps_per_unit[0] = x;
+        steps_per_unit[1] = y;
+        steps_per_unit[2] = z;
+    }
+    /*
+     * Set the motor RPM used for G0 (rapid) moves
+     */
+    void setRapidRPM(float rpm){
+        rapid_rpm = rpm;
+    }
+    /*
+     * Process one input character.
+     * Returns false if the character completes a line but the move queue is full;
+     * the same character must then be passed again later.
+     */
+    bool feed(char c);
+    /*
+     * Read and process as much input as the move queue has room for
+     */
+    void process(Stream& input);
+    /*
+     * Run the queued moves: start the next one when the group is idle and fire due steps.
+     * Returns true while a move or dwell is in progress or queued.
+     */
+    bool service(unsigned long now);
+    /*
+     * Number of free slots in the move queue
+     */
+    unsigned char available(void){
+        return GCODE_QUEUE_SIZE - queue_count;
+    }
+    /*
+     * Planned position of an axis in units, after all the queued moves complete
+     */
+    float getPosition(short axis){
+        return position[axis] / steps_per_unit[axis];
+    }
+};
+#endif // GCODE_INTERPRETER_H
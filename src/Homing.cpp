@@ -0,0 +1,174 @@
+/*
+ * Homing with limit switches
+ *
+ * Copyright (C)2026 Laurentiu Badea
+ *
+ * This file may be redistributed under the terms of the MIT license.
+ * A copy of this license has been included with this distribution in the file LICENSE.
+ */
+#include "Homing.h"
+
+Homing* Homing::slots[HOMING_MAX_AXES];
+
+void IRAM_ATTR Homing::isr0(void){
+    slots[0]->latched = true;
+}
+void IRAM_ATTR Homing::isr1(void){
+    slots[1]->latched = true;
+}
+void IRAM_ATTR Homing::isr2(void){
+    slots[2]->latched = true;
+}
+
+/*
+ * Take a free interrupt slot if the pin supports interrupts, otherwise poll
+ */
+void Homing::attach(void){
+    static void (* const isrs[HOMING_MAX_AXES])(void) = {isr0, isr1, isr2};
+    slot = -1;
+#ifdef NOT_AN_INTERRUPT
+    if (digitalPinToInterrupt(switch_pin) == NOT_AN_INTERRUPT){
+        return;
+    }
+#endif
+    for (signed char i = 0; i < HOMING_MAX_AXES; i++){
+        if (!slots[i]){
+            slots[i] = this;
+            slot = i;
+            latched = false;
+            attachInterrupt(digitalPinToInterrupt(switch_pin), isrs[i], (active_state == LOW) ? FALLING : RISING);
+            return;
+        }
+    }
+}
+
+void Homing::detach(void){
+    if (slot >= 0){
+        detachInterrupt(digitalPinToInterrupt(switch_pin));
+        slots[slot] = nullptr;
+        slot = -1;
+    }
+}
+
+void Homing::start(int direction){
+    this->direction = (direction > 0) ? 1 : -1;
+    pinMode(switch_pin, (active_state == LOW) ? INPUT_PULLUP : INPUT);
+    if (stage == IDLE || stage == DONE || stage == FAILED){
+        saved_rpm = motor.getRPM();
+    }
+    // restarting keeps one interrupt slot
+    detach();
+    attach();
+    if (isPressed()){
+        // already on the switch
+        stage = RELEASE;
+        seek_end = motor.getPosition();
+        motor.setRPM(locate_rpm);
+        motor.startMove(-this->direction * max_travel);
+    } else {
+        stage = SEEK;
+        braking = false;
+        motor.setRPM(seek_rpm);
+        motor.startMove(this->direction * max_travel);
+    }
+}
+
+bool Homing::service(unsigned long now){
+    switch (stage){
+    case SEEK:
+        if (!braking && isTriggered()){
+            // decelerate past the switch, the slow approach finds the exact point
+            motor.startBrake();
+            braking = true;
+        }
+        if (motor.service(now)){
+            return true;
+        }
+        if (!braking){
+            finish(FAILED);     // switch not found within max_travel
+            return false;
+        }
+        stage = RELEASE;
+        seek_end = motor.getPosition();
+        motor.setRPM(locate_rpm);
+        motor.startMove(-direction * max_travel);
+        return true;
+
+    case RELEASE:
+        if (!isPressed()){
+            stage = BACKOFF;
+            motor.stop();
+            motor.startMove(-direction * backoff);
+            return true;
+        }
+        if (!motor.service(now)){
+            finish(FAILED);     // switch stuck
+            return false;
+        }
+        return true;
+
+    case BACKOFF:
+        if (motor.service(now)){
+            return true;
+        }
+        stage = LOCATE;
+        latched = false;
+        // the switch triggered before the seek stopped, it cannot be further
+        motor.startMove(seek_end - motor.getPosition());
+        return true;
+
+    case LOCATE:
+        if (isTriggered()){
+            motor.stop();
+            motor.setPosition(0);
+            finish(DONE);
+            return false;
+        }
+        if (!motor.service(now)){
+            finish(FAILED);
+            return false;
+        }
+        return true;
+
+    default:
+        return false;
+    }
+}
+
+void Homing::cancel(void){
+    if (stage != IDLE && stage != DONE && stage != FAILED){
+        motor.stop();
+        finish(IDLE);
+    }
+}
+
+void Homing::finish(enum Stage stage){
+    this->stage = stage;
+    detach();
+    motor.setRPM(saved_rpm);
+}
+
+bool Homing::home(int direction){
+    start(direction);
+    while (service(micros()));
+    return isHomed();
+}
+
+bool Homing::home(Homing* const axes[], short count, int direction){
+    for (short i = 0; i < count; i++){
+        axes[i]->start(direction);
+    }
+    bool running;
+    do {
+        running = false;
+        unsigned long now = micros();
+        for (short i = 0; i < count; i++){
+            running |= axes[i]->service(now);
+        }
+    } while (running);
+    bool homed = true;
+    for (short i = 0; i < count; i++){
+        homed &= axes[i]->isHomed();
+    }
+    return homed;
+}
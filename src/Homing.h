@@ -0,0 +1,119 @@
+/*
+ * Homing with limit switches
+ *
+ * Copyright (C)2026 Laurentiu Badea
+ *
+ * This file may be redistributed under the terms of the MIT license.
+ * A copy of this license has been included with this distribution in the file LICENSE.
+ */
+#ifndef HOMING_H
+#define HOMING_H
+#include <Arduino.h>
+#include "BasicStepperDriver.h"
+
+// switches latched by interrupt at the same time; more axes fall back to polling
+#define HOMING_MAX_AXES 3
+
+#ifndef IRAM_ATTR
+#define IRAM_ATTR
+#endif
+
+/*
+ * Homing class: finds the home switch of one motor and zeroes its position there.
+ *  SEEK    move towards the switch at seek speed, brake (profile decel) when it triggers
+ *  RELEASE back off slowly until the switch releases
+ *  BACKOFF move further away by the backoff distance
+ *  LOCATE  approach again at locate speed and stop at the trigger point, which becomes 0;
+ *          fails if the switch is not found by where the seek stopped
+ * The switch is latched by a pin change interrupt where the pin supports one, so it is
+ * seen before the next step even when the loop is busy; otherwise it is polled.
+ */
+class Homing {
+public:
+    enum Stage {IDLE, SEEK, RELEASE, BACKOFF, LOCATE, DONE, FAILED};
+
+protected:
+    BasicStepperDriver& motor;
+    short switch_pin;
+    short active_state;
+    float seek_rpm = 120;
+    float locate_rpm = 10;
+    long backoff = 200;         // microsteps
+    long max_travel = 100000;   // microsteps
+    int direction = -1;
+    float saved_rpm;
+    enum Stage stage = IDLE;
+    bool braking;
+    steps_t seek_end;           // position where the seek stopped, past the switch
+
+    /*
+     * Interrupt latch
+     */
+    volatile bool latched = false;
+    signed char slot = -1;
+    static Homing* slots[HOMING_MAX_AXES];
+    static void IRAM_ATTR isr0(void);
+    static void IRAM_ATTR isr1(void);
+    static void IRAM_ATTR isr2(void);
+    void attach(void);
+    void detach(void);
+
+    bool isPressed(void){
+        return digitalRead(switch_pin) == active_state;
+    }
+    bool isTriggered(void){
+        return (slot >= 0) ? latched : isPressed();
+    }
+    void finish(enum Stage stage);
+
+public:
+    /*
+     * active_state is the switch input level when triggered (LOW: switch to GND, the
+     * internal pull-up is enabled)
+     */
+    Homing(BasicStepperDriver& motor, short switch_pin, short active_state=LOW)
+    :motor(motor), switch_pin(switch_pin), active_state(active_state)
+    {};
+    ~Homing(){
+        detach();
+    }
+    void setSpeeds(float seek_rpm, float locate_rpm){
+        this->seek_rpm = seek_rpm;
+        this->locate_rpm = locate_rpm;
+    }
+    /*
+     * backoff: distance to move away from the switch before the slow approach
+     * max_travel: give up if the switch is not found within this distance
+     */
+    void setDistances(long backoff, long max_travel){
+        this->backoff = backoff;
+        this->max_travel = max_travel;
+    }
+    /*
+     * Start homing towards the switch in the given direction (1 forward, -1 back)
+     */
+    void start(int direction=-1);
+    /*
+     * Run homing without blocking; returns true while in progress
+     */
+    bool service(unsigned long now);
+    /*
+     * Abandon homing in progress: stop the motor and release the interrupt slot
+     */
+    void cancel(void);
+    enum Stage getStage(void){
+        return stage;
+    }
+    bool isHomed(void){
+        return stage == DONE;
+    }
+    /*
+     * Home and wait until done; returns true on success
+     */
+    bool home(int direction=-1);
+    /*
+     * Home several motors (of a group) at the same time
+     */
+    static bool home(Homing* const axes[], short count, int direction=-1);
+};
+#endif // HOMING_H
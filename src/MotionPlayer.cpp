@@ -0,0 +1,127 @@
+/*
+ * Binary motion stream player for a motor group
+ *
+ * Copyright (C)2026 Laurentiu Badea
+ *
+ * This file may be redistributed under the terms of the MIT license.
+ * A copy of this license has been included with this distribution in the file LICENSE.
+ */
+#include "MotionPlayer.h"
+
+// CRC-8, polynomial 0x07
+static uint8_t crc8(const uint8_t* data, unsigned length){
+    uint8_t crc = 0;
+    while (length--){
+        crc ^= *data++;
+        for (unsigned char bit = 0; bit < 8; bit++){
+            crc = (crc & 0x80) ? (crc << 1) ^ 0x07 : crc << 1;
+        }
+    }
+    return crc;
+}
+
+/*
+ * Process one input byte
+ */
+bool MotionPlayer::feed(uint8_t c){
+    if (!received && c != MOTION_SYNC){
+        return true;    // not at a record start, skip until the next sync byte
+    }
+    if (received < MOTION_SEGMENT_SIZE - 1){
+        record[received++] = c;
+        return true;
+    }
+    // last byte is the check byte
+    if (crc8(record, MOTION_SEGMENT_SIZE - 1) != c){
+        // lost or corrupted bytes: drop the record and restart at the next sync byte in it
+        errors++;
+        record[MOTION_SEGMENT_SIZE - 1] = c;
+        unsigned char next = 1;
+        while (next < MOTION_SEGMENT_SIZE && record[next] != MOTION_SYNC){
+            next++;
+        }
+        received = MOTION_SEGMENT_SIZE - next;
+        memmove(record, record + next, received);
+        return true;
+    }
+    int16_t steps[3];
+    for (unsigned char i = 0; i < 3; i++){
+        steps[i] = (int16_t)(record[2*i+1] | ((uint16_t)record[2*i+2] << 8));
+    }
+    uint8_t flags = record[9];
+    if ((flags & MOTION_DWELL) && steps[0] < 0){
+        errors++;
+        received = 0;
+        return true;
+    }
+    if (queue_count == MOTION_QUEUE_SIZE){
+        return false;
+    }
+    Segment& segment = queue[(queue_head + queue_count) % MOTION_QUEUE_SIZE];
+    for (unsigned char i = 0; i < 3; i++){
+        segment.steps[i] = steps[i];
+    }
+    segment.rpm = record[7] | ((uint16_t)record[8] << 8);
+    segment.flags = flags;
+    queue_count++;
+    received = 0;
+    return true;
+}
+
+void MotionPlayer::process(Stream& input){
+    while (input.available()){
+        if (!feed(input.peek())){
+            break;
+        }
+        input.read();
+    }
+}
+
+/*
+ * Start the next segment when the previous one completes, and step the current one
+ */
+bool MotionPlayer::service(unsigned long now){
+    if (dwell_time){
+        if (now - dwell_start < dwell_time){
+            return true;
+        }
+        dwell_time = 0;
+    }
+    if (group.service(now)){
+        return true;
+    }
+    if (!queue_count){
+        return false;
+    }
+    startSegment(queue[queue_head], now);
+    queue_head = (queue_head + 1) % MOTION_QUEUE_SIZE;
+    queue_count--;
+    return true;
+}
+
+void MotionPlayer::startSegment(const Segment& segment, unsigned long now){
+    if (segment.flags & MOTION_END){
+        ended = true;
+    }
+    if (segment.flags & MOTION_DWELL){
+        dwell_start = now;
+        dwell_time = segment.steps[0] * 1000UL;
+        return;
+    }
+    if (segment.rpm){
+        group.setRPM((float)segment.rpm / MOTION_RPM_SCALE);
+    }
+    group.startMove(segment.steps[0], segment.steps[1], segment.steps[2]);
+}
+
+void MotionPlayer::encode(const Segment& segment, uint8_t record[MOTION_SEGMENT_SIZE]){
+    record[0] = MOTION_SYNC;
+    for (unsigned char i = 0; i < 3; i++){
+        record[2*i+1] = segment.steps[i] & 0xff;
+        record[2*i+2] = (segment.steps[i] >> 8) & 0xff;
+    }
+    record[7] = segment.rpm & 0xff;
+    record[8] = segment.rpm >> 8;
+    record[9] = segment.flags;
+    record[10] = crc8(record, MOTION_SEGMENT_SIZE - 1);
+}
@@ -0,0 +1,107 @@
+/*
+ * Binary motion stream player for a motor group
+ *
+ * Plays pre-planned jobs stored as fixed-size binary segment records (from SD card,
+ * serial etc.), with no text parsing on the MCU.
+ *
+ * Segment record format, MOTION_SEGMENT_SIZE bytes, multi-byte fields little-endian:
+ *   uint8  sync       MOTION_SYNC, marks the start of a record
+ *   int16  steps[3]   relative move for motors 0, 1, 2 (milliseconds in steps[0] for DWELL)
+ *   uint16 rpm        target speed in 1/8 RPM units, 0 = keep the current speed
+ *   uint8  flags      MOTION_DWELL, MOTION_END
+ *   uint8  check      CRC-8 (polynomial 0x07) of the 10 bytes above
+ * After lost or corrupted bytes the reader drops the record and restarts at the next
+ * sync byte. DWELL records with a negative time are dropped as invalid.
+ *
+ * extras/steps2motion.py converts step lists (CSV) to this format on the host.
+ *
+ * Copyright (C)2026 Laurentiu Badea
+ *
+ * This file may be redistributed under the terms of the MIT license.
+ * A copy of this license has been included with this distribution in the file LICENSE.
+ */
+#ifndef MOTION_PLAYER_H
+#define MOTION_PLAYER_H
+#include <Arduino.h>
+#include "MultiDriver.h"
+
+#define MOTION_SEGMENT_SIZE 11
+#define MOTION_SYNC 0xA5
+// speed field units per RPM
+#define MOTION_RPM_SCALE 8
+// segment flags
+#define MOTION_DWELL 0x01   // pause for steps[0] milliseconds instead of moving
+#define MOTION_END 0x02     // last segment of the job
+
+// number of decoded segments buffered ahead of the one in progress
+#ifndef MOTION_QUEUE_SIZE
+#define MOTION_QUEUE_SIZE 8
+#endif
+
+/*
+ * Binary motion stream player class.
+ * Records are decoded as bytes arrive and queued; service() feeds them to the group
+ * without blocking.
+ */
+class MotionPlayer {
+public:
+    struct Segment {
+        int16_t steps[3];
+        uint16_t rpm;
+        uint8_t flags;
+    };
+
+protected:
+    MultiDriver& group;
+    // record being received
+    uint8_t record[MOTION_SEGMENT_SIZE];
+    unsigned char received = 0;
+    // decoded segment queue (ring buffer)
+    Segment queue[MOTION_QUEUE_SIZE];
+    unsigned char queue_head = 0;
+    unsigned char queue_count = 0;
+    // DWELL in progress
+    unsigned long dwell_start;
+    unsigned long dwell_time = 0;
+    bool ended = false;
+    unsigned errors = 0;
+
+    void startSegment(const Segment& segment, unsigned long now);
+
+public:
+    MotionPlayer(MultiDriver& group)
+    :group(group)
+    {};
+    /*
+     * Process one input byte.
+     * Returns false if the byte completes a record but the queue is full;
+     * the same byte must then be passed again later.
+     */
+    bool feed(uint8_t c);
+    /*
+     * Read and process as much input as the queue has room for
+     */
+    void process(Stream& input);
+    /*
+     * Run the queued segments: start the next one when the group is idle and fire due steps.
+     * Returns true while a segment is in progress or queued.
+     */
+    bool service(unsigned long now);
+    /*
+     * True once the MOTION_END segment has been played
+     */
+    bool isEnded(void){
+        return ended && !queue_count && !dwell_time && !group.isRunning();
+    }
+    /*
+     * Number of records dropped due to a checksum mismatch or an invalid dwell time
+     */
+    unsigned getErrors(void){
+        return errors;
+    }
+    /*
+     * Encode a segment into a record (for generating streams on the MCU or a host)
+     */
+    static void encode(const Segment& segment, uint8_t record[MOTION_SEGMENT_SIZE]);
+};
+#endif // MOTION_PLAYER_H
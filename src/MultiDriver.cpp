@@ -13,13 +13,19 @@
 /*
  * Initialize motor parameters
  */
-void MultiDriver::startMove(long steps1, long steps2, long steps3){
-    long steps[3] = {steps1, steps2, steps3};
+void MultiDriver::startMove(steps_t steps1, steps_t steps2, steps_t steps3){
+    steps_t steps[3] = {steps1, steps2, steps3};
+    if (gear_slave >= 0){
+        // count the master steps of the last move before a new one restarts them,
+        // and wake the slave together with the others
+        followGear();
+        motors[gear_slave]->wake();
+    }
     /*
      * Initialize state for all active motors
      */
     FOREACH_MOTOR(
-        if (steps[i]){
+        if (steps[i] && i != gear_slave){
             motors[i]->startMove(steps[i]);
             event_timers[i] = 1;
         } else {
@@ -27,14 +33,20 @@ void MultiDriver::startMove(long steps1, long steps2, long steps3){
         }
     );
     ready = false;
-    last_action_end = 0;
+    last_action_due = 0;
     next_action_interval = 1;
 }
 /*
  * Trigger next step action
  */
 long MultiDriver::nextAction(void){
-    Motor::delayMicros(next_action_interval, last_action_end);
+    Motor::delayMicros(next_action_interval, last_action_due);
+    // absolute schedule like the motors' own (see BasicStepperDriver::emitStep())
+    unsigned long start = micros();
+    unsigned long due = last_action_due + next_action_interval;
+    if (!last_action_due || start - due >= next_action_interval){
+        due = start;
+    }
 
     // TODO: unroll these loops
     // Trigger all the motors that need it
@@ -45,7 +57,14 @@ long MultiDriver::nextAction(void){
             event_timers[i] -= next_action_interval;
         }
     );
-    last_action_end = micros();
+    last_action_due = due;
+    if (gear_slave >= 0){
+        followGear();
+        if (!event_timers[gear_slave] && motors[gear_slave]->getStepsRemaining() > 0){
+            // new slave steps, due right away
+            event_timers[gear_slave] = 1;
+        }
+    }
 
     next_action_interval = 0;
     // Find the time when the next pulse needs to fire
@@ -59,6 +78,87 @@ long MultiDriver::nextAction(void){
 
     return next_action_interval;
 }
+/*
+ * Fire the steps that are due and return immediately.
+ * Each motor keeps its own deadline, so event_timers[] only flags the active motors.
+ * Stopped motors are serviced too, for their housekeeping (auto power, state
+ * notifications) while the others still move and after the group move.
+ */
+bool MultiDriver::service(unsigned long now){
+    bool running = false;
+    FOREACH_MOTOR(
+        if (motors[i]->service(now)){
+            running = true;
+        } else {
+            event_timers[i] = 0;
+        }
+    );
+    if (gear_slave >= 0){
+        followGear();
+    }
+    ready = !running;
+    return running;
+}
+
+bool MultiDriver::setGear(short master, short slave, long ratio_num, long ratio_den){
+    if (ratio_den <= 0 || master < 0 || master >= count || slave < 0 || slave >= count ||
+        master == slave){
+        return false;
+    }
+    if (master == gear_master && slave == gear_slave){
+        // ratio change in flight: keep the fractional position
+        gear_acc = gear_acc * ratio_den / gear_den;
+    } else {
+        gear_acc = 0;
+        gear_last = motors[master]->getStepsCompleted();
+        gear_move = motors[master]->getMoveCount();
+    }
+    gear_num = ratio_num;
+    gear_den = ratio_den;
+    gear_master = master;
+    gear_slave = slave;
+    event_timers[slave] = 0;
+    return true;
+}
+/*
+ * Queue the slave steps for the master steps taken since the last check
+ * (integer accumulation, no profile of its own). They are fired by the slave's own
+ * service()/nextAction() like any other step, never waited for here.
+ */
+void MultiDriver::followGear(void){
+    Motor& master = *motors[gear_master];
+    steps_t completed = master.getStepsCompleted();
+    if (master.getMoveCount() != gear_move){
+        gear_move = master.getMoveCount();
+        gear_last = 0;      // the master started a new move
+    }
+    if (completed == gear_last){
+        return;
+    }
+    gear_acc += (completed - gear_last) * gear_num;
+    gear_last = completed;
+    // whole slave steps, the remainder stays in gear_acc
+    long steps = gear_acc / gear_den;
+    if (steps){
+        gear_acc -= steps * gear_den;
+        motors[gear_slave]->queueSteps(steps * master.getDirection());
+    }
+}
+
+unsigned long MultiDriver::getTimeToNextAction(unsigned long now){
+    unsigned long next = 0;
+    bool found = false;
+    FOREACH_MOTOR(
+        if (event_timers[i]){
+            unsigned long t = motors[i]->getTimeToNextAction(now);
+            if (!found || t < next){
+                next = t;
+                found = true;
+            }
+        }
+    );
+    return next;
+}
 /*
  * Optionally, call this to begin braking to stop early
  */
@@ -76,7 +176,7 @@ void MultiDriver::startBrake(void){
 MultiDriver::Steps MultiDriver::stop(void){
     Steps retval = Steps();
     FOREACH_MOTOR(
-        if (event_timers[i] > 0){
+        if (event_timers[i] > 0 || i == gear_slave){
             retval.steps[i] = motors[i]->stop();
         }
     )
@@ -103,13 +203,14 @@ void MultiDriver::begin(float rpm, short microsteps){
     FOREACH_MOTOR(
         motors[i]->begin(rpm, microsteps);
     )
+    enable();
 }
 
 /*
  * Move each motor the requested number of steps, in parallel
  * positive to move forward, negative to reverse, 0 to remain still
  */
-void MultiDriver::move(long steps1, long steps2, long steps3){
+void MultiDriver::move(steps_t steps1, steps_t steps2, steps_t steps3){
     startMove(steps1, steps2, steps3);
     while (!ready){
         nextAction();
@@ -141,8 +242,22 @@ void MultiDriver::setRPM(float rpm){
     FOREACH_MOTOR(motors[i]->setRPM(rpm));
 }
 
+void MultiDriver::setFeedOverride(float factor){
+    FOREACH_MOTOR(motors[i]->setFeedOverride(factor));
+}
+
+/*
+ * Wake up all the drivers first, then wait once for the slowest one
+ */
 void MultiDriver::enable(void){
-    FOREACH_MOTOR(motors[i]->enable());
+    short wait = 0;
+    FOREACH_MOTOR(
+        short motor_wait = motors[i]->startEnable();
+        if (motor_wait > wait){
+            wait = motor_wait;
+        }
+    )
+    Motor::delayMicros(wait);
 }
 void MultiDriver::disable(void){
     FOREACH_MOTOR(motors[i]->disable());
@@ -38,11 +38,24 @@ protected:
     // when next state change is due for each motor
     unsigned long event_timers[MAX_MOTORS];
     unsigned long next_action_interval = 0;
-    unsigned long last_action_end = 0;
+    unsigned long last_action_due = 0;
+
+    /*
+     * Electronic gearing: the slave steps gear_num/gear_den times per master step.
+     * gear_acc is the fractional slave position in 1/gear_den steps.
+     */
+    short gear_master = -1;
+    short gear_slave = -1;
+    long gear_num;
+    long gear_den;
+    long gear_acc = 0;
+    steps_t gear_last = 0;  // master steps completed when last checked
+    unsigned gear_move;     // master move count when last checked
+    void followGear(void);
 
 public:
     struct Steps {
-        long steps[3];
+        steps_t steps[3];
     };
     /*
      * Two-motor setup
@@ -70,7 +83,7 @@ public:
      * Move the motors a given number of steps.
      * positive to move forward, negative to reverse
      */
-    void move(long steps1, long steps2, long steps3=0);
+    void move(steps_t steps1, steps_t steps2, steps_t steps3=0);
     void rotate(int deg1, int deg2, int deg3=0){
         rotate((long)deg1, (long)deg2, (long)deg3);
     };
@@ -80,7 +93,7 @@ public:
     /*
      * Motor movement with external control of timing
      */
-    virtual void startMove(long steps1, long steps2, long steps3=0);
+    virtual void startMove(steps_t steps1, steps_t steps2, steps_t steps3=0);
     void startRotate(int deg1, int deg2, int deg3=0){
         startRotate((long)deg1, (long)deg2, (long)deg3);
     };
@@ -90,6 +103,16 @@ public:
      * Toggle step and return time until next change is needed (micros)
      */
     virtual long nextAction(void);
+    /*
+     * Polling alternative to nextAction() which never waits for the next step.
+     * Fires the steps due at time <now> (micros()) and returns immediately.
+     * Returns true while any motor is moving, false when all moves are complete.
+     */
+    virtual bool service(unsigned long now);
+    /*
+     * Return time left until the next step of any motor is due (micros), 0 if due or stopped
+     */
+    virtual unsigned long getTimeToNextAction(unsigned long now);
     /*
      * Optionally, call this to begin braking to stop early
      */
@@ -113,9 +136,29 @@ public:
      */
     void setRPM(float rpm);
     /*
-     * Turn all motors on or off
+     * Feed override (0.1 - 2.0) on all motors, including the moves in progress,
+     * see BasicStepperDriver::setFeedOverride()
+     */
+    virtual void setFeedOverride(float factor);
+    /*
+     * Turn all motors on or off.
+     * enable() (also called by begin()) waits once for the longest driver wakeup time.
      */
     void enable(void);
     void disable(void);
+    /*
+     * Electronic gearing: motor <slave> follows motor <master>, stepping ratio_num/ratio_den
+     * times per master step (negative to turn the other way), on the master's steps.
+     * The slave has no move of its own; its steps in startMove() are ignored. Its steps
+     * are queued (BasicStepperDriver::queueSteps()) and fired by nextAction()/service()
+     * like the others, so service() still never waits.
+     * May be called while moving to change the ratio.
+     * Returns false, leaving the gearing unchanged, if ratio_den is not positive or
+     * master and slave are not two different motors of the group.
+     */
+    bool setGear(short master, short slave, long ratio_num, long ratio_den=1);
+    void clearGear(void){
+        gear_slave = gear_master = -1;
+    }
 };
 #endif // MULTI_DRIVER_H
@@ -0,0 +1,86 @@
+/*
+ * Group of control pins updated together (microstep mode pins etc.)
+ *
+ * Copyright (C)2026 Laurentiu Badea
+ *
+ * This file may be redistributed under the terms of the MIT license.
+ * A copy of this license has been included with this distribution in the file LICENSE.
+ */
+#include "PinGroup.h"
+
+void PinGroup::begin(short pin0, short pin1, short pin2){
+    short all[PIN_GROUP_MAX_PINS] = {pin0, pin1, pin2};
+    count = 0;
+    drive = 0;
+    for (unsigned char i = 0; i < PIN_GROUP_MAX_PINS; i++){
+        if (i < 2 && !IS_CONNECTED(all[i])){
+            count = 0;
+            return;
+        }
+        if (IS_CONNECTED(all[i])){
+            pins[count++] = all[i];
+        }
+    }
+#ifdef __AVR__
+    uint8_t port = digitalPinToPort(pins[0]);
+    out_reg = nullptr;
+    port_mask = 0;
+    for (unsigned char i = 0; i < count; i++){
+        if (digitalPinToPort(pins[i]) != port || port == NOT_A_PIN){
+            return;
+        }
+        bits[i] = digitalPinToBitMask(pins[i]);
+        port_mask |= bits[i];
+    }
+    out_reg = portOutputRegister(port);
+    mode_reg = portModeRegister(port);
+#endif
+}
+
+struct PinGroup::State PinGroup::prepare(uint8_t value, uint8_t drive){
+    State state = {value, drive};
+#ifdef __AVR__
+    if (out_reg){
+        // translate to port bits, high impedance pins have PORT=0 (no pull-up)
+        state.value = state.drive = 0;
+        for (unsigned char i = 0; i < count; i++){
+            if (drive & (1<<i)){
+                state.drive |= bits[i];
+                if (value & (1<<i)){
+                    state.value |= bits[i];
+                }
+            }
+        }
+    }
+#endif
+    return state;
+}
+
+void PinGroup::apply(struct State state){
+#ifdef __AVR__
+    if (out_reg){
+        uint8_t oldSREG = SREG;
+        cli();
+        // release pins going high impedance first, then set levels while the newly
+        // driven pins are still inputs, then drive them, so no pin is briefly driven
+        // to a wrong level
+        *mode_reg &= ~port_mask | state.drive;
+        *out_reg = (*out_reg & ~port_mask) | state.value;
+        *mode_reg |= state.drive;
+        SREG = oldSREG;
+        return;
+    }
+#endif
+    for (unsigned char i = 0; i < count; i++){
+        uint8_t bit = 1<<i;
+        if (state.drive & bit){
+            digitalWrite(pins[i], (state.value & bit) ? HIGH : LOW);
+            if (!(drive & bit)){
+                pinMode(pins[i], OUTPUT);
+            }
+        } else if (drive & bit){
+            pinMode(pins[i], INPUT); // Z - high impedance
+        }
+    }
+    drive = state.drive;
+}
@@ -0,0 +1,67 @@
+/*
+ * Group of control pins updated together (microstep mode pins etc.)
+ *
+ * Copyright (C)2026 Laurentiu Badea
+ *
+ * This file may be redistributed under the terms of the MIT license.
+ * A copy of this license has been included with this distribution in the file LICENSE.
+ */
+#ifndef PIN_GROUP_H
+#define PIN_GROUP_H
+#include <Arduino.h>
+#include "BasicStepperDriver.h"
+
+#define PIN_GROUP_MAX_PINS 3
+// one state per microstep level 1..128
+#define PIN_GROUP_MAX_STATES 8
+
+/*
+ * Pin group class.
+ * States are prepared once (in begin()) and then applied cheaply. On AVR, when all the
+ * pins are on the same port, a state is applied by writing the port's DDR and PORT
+ * registers with interrupts disabled, so all pins change together with no intermediate
+ * modes. Otherwise it falls back to digitalWrite(), calling pinMode() only when a pin
+ * switches between driven and high impedance.
+ */
+class PinGroup {
+public:
+    /*
+     * Pin levels (value) and which pins are driven (drive), others are high impedance.
+     * Before prepare(), bit i is for pin i; after, the bits are in the applied form.
+     */
+    struct State {
+        uint8_t value;
+        uint8_t drive;
+    };
+
+protected:
+    short pins[PIN_GROUP_MAX_PINS];
+    unsigned char count = 0;
+    // currently driven pins (fallback only)
+    uint8_t drive = 0;
+#ifdef __AVR__
+    // port registers, null if the pins are not all on the same port
+    volatile uint8_t* out_reg = nullptr;
+    volatile uint8_t* mode_reg = nullptr;
+    uint8_t bits[PIN_GROUP_MAX_PINS];
+    uint8_t port_mask = 0;
+#endif
+
+public:
+    /*
+     * Set up the pins. The group is left empty (and does nothing) if any pin is not connected.
+     */
+    void begin(short pin0, short pin1, short pin2=PIN_UNCONNECTED);
+    bool isConnected(void){
+        return count > 0;
+    }
+    /*
+     * Convert pin levels and driven pins (bit i for pin i) to the form apply() uses
+     */
+    struct State prepare(uint8_t value, uint8_t drive=0xff);
+    /*
+     * Set all the pins to a prepared state
+     */
+    void apply(struct State state);
+};
+#endif // PIN_GROUP_H
@@ -0,0 +1,167 @@
+/*
+ * Power-loss-safe position journal
+ *
+ * Copyright (C)2026 Laurentiu Badea
+ *
+ * This file may be redistributed under the terms of the MIT license.
+ * A copy of this license has been included with this distribution in the file LICENSE.
+ */
+#include "PositionJournal.h"
+
+// CRC-8, polynomial 0x07
+static uint8_t crc8(const uint8_t* data, unsigned length){
+    uint8_t crc = 0;
+    while (length--){
+        crc ^= *data++;
+        for (uint8_t bit = 0; bit < 8; bit++){
+            crc = (crc & 0x80) ? (crc << 1) ^ 0x07 : crc << 1;
+        }
+    }
+    return crc;
+}
+
+bool PositionJournal::readRecord(unsigned slot, uint16_t& sequence, uint8_t& flags,
+                                 steps_t& position, steps_t& target){
+    uint8_t record[POSITION_JOURNAL_RECORD_SIZE];
+    unsigned address = slot * POSITION_JOURNAL_RECORD_SIZE;
+    for (unsigned i = 0; i < POSITION_JOURNAL_RECORD_SIZE; i++){
+        record[i] = storage.read(address + i);
+    }
+    // the magic rejects blank (0x00 or 0xFF) storage, the CRC torn or stale bytes
+    if ((record[2] & ~POSITION_JOURNAL_MOVING) != POSITION_JOURNAL_MAGIC ||
+        crc8(record, POSITION_JOURNAL_RECORD_SIZE - 1) != record[POSITION_JOURNAL_RECORD_SIZE - 1]){
+        return false;
+    }
+    memcpy(&sequence, record, 2);
+    flags = record[2];
+    memcpy(&position, record + 3, sizeof(steps_t));
+    memcpy(&target, record + 3 + sizeof(steps_t), sizeof(steps_t));
+    return true;
+}
+
+/*
+ * Start a record of the current state; writeNext() stores it
+ */
+void PositionJournal::write(bool moving, unsigned long now){
+    if (!slots){
+        return;
+    }
+    record_moving = moving;
+    record_position = record_target = motor.getPosition();
+    if (moving){
+        record_target += motor.getDirection() * motor.getStepsRemaining();
+    }
+    record_time = now;
+    // next slot, the current record stays valid until this one is complete
+    slot = (slot + 1 < slots) ? slot + 1 : 0;
+    sequence++;
+    memcpy(record, &sequence, 2);
+    record[2] = POSITION_JOURNAL_MAGIC | (moving ? POSITION_JOURNAL_MOVING : 0);
+    memcpy(record + 3, &record_position, sizeof(steps_t));
+    memcpy(record + 3 + sizeof(steps_t), &record_target, sizeof(steps_t));
+    record[POSITION_JOURNAL_RECORD_SIZE - 1] = crc8(record, POSITION_JOURNAL_RECORD_SIZE - 1);
+    written = 0;
+    writeNext();
+}
+
+/*
+ * Write the bytes of the record in progress for which the storage is ready, without
+ * waiting. The journal state follows once the record is complete.
+ */
+void PositionJournal::writeNext(void){
+    unsigned address = slot * POSITION_JOURNAL_RECORD_SIZE;
+    while (written < POSITION_JOURNAL_RECORD_SIZE && storage.isReady()){
+        storage.write(address + written, record[written]);
+        written++;
+    }
+    if (written == POSITION_JOURNAL_RECORD_SIZE){
+        storage.commit();
+        moving = record_moving;
+        saved_position = record_position;
+        target = record_target;
+        last_write = record_time;
+    }
+}
+
+/*
+ * Complete the record in progress, if any
+ */
+void PositionJournal::flush(void){
+    while (written < POSITION_JOURNAL_RECORD_SIZE){
+        writeNext();
+    }
+}
+
+bool PositionJournal::begin(void){
+    slots = storage.size() / POSITION_JOURNAL_RECORD_SIZE;
+    // with no valid record the first one goes to slot 0
+    slot = slots - 1;
+    sequence = 0;
+    exact = false;
+    written = POSITION_JOURNAL_RECORD_SIZE;
+    bool found = false;
+    for (unsigned i = 0; i < slots; i++){
+        uint16_t record_sequence;
+        uint8_t flags;
+        steps_t position, record_target;
+        if (!readRecord(i, record_sequence, flags, position, record_target)){
+            continue;
+        }
+        // newest by sequence, which wraps around
+        if (found && (int16_t)(record_sequence - sequence) <= 0){
+            continue;
+        }
+        found = true;
+        slot = i;
+        sequence = record_sequence;
+        exact = !(flags & POSITION_JOURNAL_MOVING);
+        saved_position = position;
+        target = record_target;
+    }
+    if (found){
+        motor.setPosition(saved_position);
+    } else {
+        saved_position = motor.getPosition();
+        target = saved_position;
+    }
+    // the record stays as is until the motor moves (or is set), so an interrupted
+    // move is still reported after another reset
+    moving = false;
+    return found;
+}
+
+bool PositionJournal::update(unsigned long now){
+    if (written < POSITION_JOURNAL_RECORD_SIZE){
+        writeNext();
+        if (written < POSITION_JOURNAL_RECORD_SIZE){
+            return true;
+        }
+    }
+    if (motor.getCurrentState() != BasicStepperDriver::STOPPED){
+        if (!moving || (interval && now - last_write >= interval)){
+            write(true, now);
+        }
+    } else if (moving || motor.getPosition() != saved_position){
+        write(false, now);
+    }
+    return written < POSITION_JOURNAL_RECORD_SIZE;
+}
+
+void PositionJournal::startMove(steps_t steps){
+    motor.startMove(steps);
+    // journal the move before its first step
+    flush();
+    update(micros());
+    flush();
+}
+
+void PositionJournal::move(steps_t steps){
+    startMove(steps);
+    while (service(micros()));
+}
+
+bool PositionJournal::service(unsigned long now){
+    bool running = motor.service(now);
+    // until the record of the end of the move is complete
+    return update(now) || running;
+}
@@ -0,0 +1,190 @@
+/*
+ * Power-loss-safe position journal
+ *
+ * Keeps a motor's absolute position and move state in EEPROM (or flash emulated
+ * EEPROM), so it can be restored after a reset or power loss without homing.
+ *
+ * The storage is used as a ring of fixed-size records, each one written to the slot
+ * after the previous one (wear leveling). Record format, native byte order:
+ *   uint16  sequence   incremented with each record, the highest one is current
+ *   uint8   flags      POSITION_JOURNAL_MAGIC | POSITION_JOURNAL_MOVING
+ *   steps_t position   absolute position (microsteps) when written
+ *   steps_t target     move target if MOVING, otherwise position
+ *   uint8   check      CRC-8 of the bytes above
+ * A record torn by a power loss fails its check, and the previous one is used.
+ *
+ * Copyright (C)2026 Laurentiu Badea
+ *
+ * This file may be redistributed under the terms of the MIT license.
+ * A copy of this license has been included with this distribution in the file LICENSE.
+ */
+#ifndef POSITION_JOURNAL_H
+#define POSITION_JOURNAL_H
+#include <Arduino.h>
+#include "BasicStepperDriver.h"
+
+#define POSITION_JOURNAL_RECORD_SIZE (4 + 2 * sizeof(steps_t))
+// record flags
+#define POSITION_JOURNAL_MOVING 0x01
+#define POSITION_JOURNAL_MAGIC 0xA4
+
+/*
+ * Byte storage for the journal. Implement it for other media (FRAM, flash pages,
+ * a file on the host).
+ */
+class JournalStorage {
+public:
+    virtual unsigned size(void) = 0;
+    virtual uint8_t read(unsigned address) = 0;
+    virtual void write(unsigned address, uint8_t value) = 0;
+    /*
+     * Make the writes so far durable, called after each record
+     */
+    virtual void commit(void){};
+    /*
+     * False while a write is still in progress, so the next one would have to wait
+     */
+    virtual bool isReady(void){
+        return true;
+    }
+};
+
+#if defined(__has_include)
+#if __has_include(<EEPROM.h>)
+#include <EEPROM.h>
+#define POSITION_JOURNAL_EEPROM
+/*
+ * EEPROM area [start, start+length) as journal storage.
+ * Only changed bytes are written. On ESP32/ESP8266 call EEPROM.begin(size) first.
+ * Sketches should #include <EEPROM.h> themselves, so the IDE adds the library.
+ */
+class EEPROMStorage : public JournalStorage {
+protected:
+    unsigned start;
+    unsigned length;
+
+public:
+    EEPROMStorage(unsigned start, unsigned length)
+    :start(start), length(length)
+    {};
+    unsigned size(void) override {
+        return length;
+    }
+    uint8_t read(unsigned address) override {
+        return EEPROM.read(start + address);
+    }
+    void write(unsigned address, uint8_t value) override {
+        if (EEPROM.read(start + address) != value){
+            EEPROM.write(start + address, value);
+        }
+    }
+    void commit(void) override {
+#if defined(ARDUINO_ARCH_ESP32) || defined(ARDUINO_ARCH_ESP8266)
+        EEPROM.commit();
+#endif
+    }
+#ifdef __AVR__
+    // a byte write takes about 3.3ms, EEPROM.write() would wait for the previous one
+    bool isReady(void) override {
+        return eeprom_is_ready();
+    }
+#endif
+};
+#endif // __has_include(<EEPROM.h>)
+#endif // __has_include
+
+/*
+ * Position journal class.
+ * Records are written when a move starts, when it ends (or the position is set while
+ * stopped), and optionally every few seconds while moving. Never from the step path:
+ * service() and update() write them between steps, one byte per call while the
+ * storage is busy (AVR EEPROM takes about 3.3ms per byte), so they do not hold up
+ * the next step. startMove() and save() wait for their record to complete.
+ */
+class PositionJournal {
+protected:
+    BasicStepperDriver& motor;
+    JournalStorage& storage;
+    unsigned slots = 0;
+    // slot of the current record
+    unsigned slot;
+    uint16_t sequence = 0;
+    // state of the current record
+    bool moving = false;
+    steps_t saved_position = 0;
+    steps_t target = 0;
+    unsigned long interval = 0;
+    unsigned long last_write;
+    bool exact = false;
+    /*
+     * Record being written, and the state it holds
+     */
+    uint8_t record[POSITION_JOURNAL_RECORD_SIZE];
+    unsigned char written = POSITION_JOURNAL_RECORD_SIZE;   // bytes of it written so far
+    bool record_moving;
+    steps_t record_position;
+    steps_t record_target;
+    unsigned long record_time;
+
+    bool readRecord(unsigned slot, uint16_t& sequence, uint8_t& flags,
+                    steps_t& position, steps_t& target);
+    void write(bool moving, unsigned long now);
+    void writeNext(void);
+    void flush(void);
+
+public:
+    PositionJournal(BasicStepperDriver& motor, JournalStorage& storage)
+    :motor(motor), storage(storage)
+    {};
+    /*
+     * Call after the motor's begin(). Restores the motor position from the current
+     * record and returns true, or returns false if there is none (blank storage).
+     */
+    bool begin(void);
+    /*
+     * True if the restored position is exact: the last move had completed.
+     * Otherwise power was lost while moving and the position is the last one
+     * journaled; home the motor, the new position is then journaled.
+     */
+    bool isExact(void){
+        return exact;
+    }
+    /*
+     * Target of the move in progress when the current record was written
+     * (the position if stopped), e.g. to resume an interrupted move after homing
+     */
+    steps_t getTarget(void){
+        return target;
+    }
+    /*
+     * Also journal the position every <ms> milliseconds while moving, 0 = off (default)
+     */
+    void setInterval(unsigned long ms){
+        interval = ms * 1000;
+    }
+    void startMove(steps_t steps);
+    void move(steps_t steps);
+    /*
+     * Step the motor and journal it; returns true while the move is in progress or
+     * its record is still being written
+     */
+    bool service(unsigned long now);
+    /*
+     * Journal the motor if needed, for motors moved by other means (MultiDriver,
+     * SyncDriver, blocking moves). Call between steps and after the moves.
+     * Returns true while a record is still being written.
+     */
+    bool update(unsigned long now);
+    /*
+     * Write a record of the current state now
+     */
+    void save(void){
+        flush();
+        write(motor.getCurrentState() != BasicStepperDriver::STOPPED, micros());
+        flush();
+    }
+    uint16_t getSequence(void){
+        return sequence;
+    }
+};
+#endif // POSITION_JOURNAL_H
@@ -0,0 +1,46 @@
+/*
+ * Quadrature encoder input
+ *
+ * Copyright (C)2026 Laurentiu Badea
+ *
+ * This file may be redistributed under the terms of the MIT license.
+ * A copy of this license has been included with this distribution in the file LICENSE.
+ */
+#include "QuadratureEncoder.h"
+
+QuadratureEncoder* QuadratureEncoder::slots[QUADRATURE_MAX_ENCODERS];
+
+void IRAM_ATTR QuadratureEncoder::isr0(void){
+    slots[0]->update();
+}
+void IRAM_ATTR QuadratureEncoder::isr1(void){
+    slots[1]->update();
+}
+void IRAM_ATTR QuadratureEncoder::isr2(void){
+    slots[2]->update();
+}
+
+bool QuadratureEncoder::begin(void){
+    static void (* const isrs[QUADRATURE_MAX_ENCODERS])(void) = {isr0, isr1, isr2};
+    pinMode(pin_a, INPUT_PULLUP);
+    pinMode(pin_b, INPUT_PULLUP);
+    state = (digitalRead(pin_a) << 1) | digitalRead(pin_b);
+    if (slot >= 0){
+        return true;
+    }
+#ifdef NOT_AN_INTERRUPT
+    if (digitalPinToInterrupt(pin_a) == NOT_AN_INTERRUPT || digitalPinToInterrupt(pin_b) == NOT_AN_INTERRUPT){
+        return false;
+    }
+#endif
+    for (signed char i = 0; i < QUADRATURE_MAX_ENCODERS; i++){
+        if (!slots[i]){
+            slots[i] = this;
+            slot = i;
+            attachInterrupt(digitalPinToInterrupt(pin_a), isrs[i], CHANGE);
+            attachInterrupt(digitalPinToInterrupt(pin_b), isrs[i], CHANGE);
+            return true;
+        }
+    }
+    return false;
+}
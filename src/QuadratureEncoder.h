@@ -0,0 +1,89 @@
+/*
+ * Quadrature encoder input
+ *
+ * Copyright (C)2026 Laurentiu Badea
+ *
+ * This file may be redistributed under the terms of the MIT license.
+ * A copy of this license has been included with this distribution in the file LICENSE.
+ */
+#ifndef QUADRATURE_ENCODER_H
+#define QUADRATURE_ENCODER_H
+#include <Arduino.h>
+
+// encoders counted from pin change interrupts; others need poll()
+#define QUADRATURE_MAX_ENCODERS 3
+
+#ifndef IRAM_ATTR
+#define IRAM_ATTR
+#endif
+
+/*
+ * Quadrature encoder class.
+ * Counts all 4 edges per line (e.g. 4000 counts per revolution for a 1000 line encoder).
+ * Both pins need pin change interrupts to count in the background, otherwise poll()
+ * must be called faster than the edges arrive.
+ */
+class QuadratureEncoder {
+protected:
+    short pin_a;
+    short pin_b;
+    volatile long position = 0;
+    volatile uint8_t state = 0;     // last A, B levels
+    signed char slot = -1;
+    static QuadratureEncoder* slots[QUADRATURE_MAX_ENCODERS];
+    static void IRAM_ATTR isr0(void);
+    static void IRAM_ATTR isr1(void);
+    static void IRAM_ATTR isr2(void);
+
+    inline void update(void){
+        // count +1/-1 from the previous and current A, B levels (0 for no or invalid change)
+        static const signed char STEPS[16] = {0, -1, 1, 0, 1, 0, 0, -1, -1, 0, 0, 1, 0, 1, -1, 0};
+        uint8_t levels = (digitalRead(pin_a) << 1) | digitalRead(pin_b);
+        position += STEPS[(state << 2) | levels];
+        state = levels;
+    }
+
+public:
+    QuadratureEncoder(short pin_a, short pin_b)
+    :pin_a(pin_a), pin_b(pin_b)
+    {};
+    /*
+     * Set up the pins (with pull-ups) and the interrupts.
+     * Returns false if interrupts are not available, poll() must be used then.
+     */
+    bool begin(void);
+    /*
+     * Count pending edges; does nothing when counting from interrupts
+     */
+    void poll(void){
+        if (slot < 0){
+            update();
+        }
+    }
+    /*
+     * Count, safe to call with interrupts disabled (e.g. from a timer interrupt)
+     */
+    long read(void){
+#ifdef __AVR__
+        // 32-bit access takes several instructions here; keep the caller's interrupt state
+        uint8_t oldSREG = SREG;
+        cli();
+        long value = position;
+        SREG = oldSREG;
+        return value;
+#else
+        return position;
+#endif
+    }
+    void write(long value){
+#ifdef __AVR__
+        uint8_t oldSREG = SREG;
+        cli();
+        position = value;
+        SREG = oldSREG;
+#else
+        position = value;
+#endif
+    }
+};
+#endif // QUADRATURE_ENCODER_H
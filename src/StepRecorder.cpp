@@ -0,0 +1,125 @@
+/*
+ * Step sequence recorder
+ *
+ * Copyright (C)2026 Laurentiu Badea
+ *
+ * This file may be redistributed under the terms of the MIT license.
+ * A copy of this license has been included with this distribution in the file LICENSE.
+ */
+#include "StepRecorder.h"
+
+void StepRecorder::clear(void){
+#ifdef __AVR__
+    uint8_t oldSREG = SREG;
+    cli();
+#endif
+    tail = head;
+    started = false;
+    lost = 0;
+#ifdef __AVR__
+    SREG = oldSREG;
+#endif
+    lost_reported = 0;
+    pending_dt = 0;
+}
+
+unsigned short StepRecorder::readHead(void){
+#ifdef __AVR__
+    uint8_t oldSREG = SREG;
+    cli();
+    unsigned short value = head;
+    SREG = oldSREG;
+    return value;
+#else
+    return head;
+#endif
+}
+
+unsigned long StepRecorder::readLost(void){
+#ifdef __AVR__
+    uint8_t oldSREG = SREG;
+    cli();
+    unsigned long value = lost;
+    SREG = oldSREG;
+    return value;
+#else
+    return lost;
+#endif
+}
+
+bool StepRecorder::put(uint16_t dt, uint8_t flags){
+    unsigned short next = head + 1;
+    if (next == size){
+        next = 0;
+    }
+    if (next == tail){
+        lost++;
+        return false;
+    }
+    buffer[head].dt = dt;
+    buffer[head].flags = flags;
+    head = next;
+    return true;
+}
+
+void StepRecorder::record(unsigned long now, uint8_t flags){
+    unsigned long dt = 0;
+    if (started){
+        dt = now - last_time;
+    }
+    started = true;
+    // the time base advances even if the event is lost, so later steps keep their time
+    last_time = now;
+    while (dt > 0xFFFF){
+        if (!put(0xFFFF, STEP_RECORDER_GAP)){
+            return;
+        }
+        dt -= 0xFFFF;
+    }
+    put(dt, flags & ~STEP_RECORDER_GAP);
+}
+
+bool StepRecorder::read(Event& event){
+    if (readHead() == tail){
+        return false;
+    }
+    event = buffer[tail];
+    unsigned short next = tail + 1;
+    if (next == size){
+        next = 0;
+    }
+#ifdef __AVR__
+    uint8_t oldSREG = SREG;
+    cli();
+    tail = next;
+    SREG = oldSREG;
+#else
+    tail = next;
+#endif
+    return true;
+}
+
+unsigned short StepRecorder::print(Print& out, unsigned short max){
+    unsigned short count = 0;
+    Event event;
+    while (count < max && read(event)){
+        pending_dt += event.dt;
+        if (event.flags & STEP_RECORDER_GAP){
+            continue;
+        }
+        out.print(pending_dt);
+        out.print(' ');
+        out.print((event.flags & STEP_RECORDER_ID_MASK) >> STEP_RECORDER_ID_SHIFT);
+        out.print(' ');
+        out.println(event.flags & STEP_RECORDER_DIR);
+        pending_dt = 0;
+        count++;
+    }
+    unsigned long total = readLost();
+    if (total != lost_reported){
+        out.print("# lost ");
+        out.println(total - lost_reported);
+        lost_reported = total;
+    }
+    return count;
+}
@@ -0,0 +1,98 @@
+/*
+ * Step sequence recorder
+ *
+ * Captures the STEP/DIR sequence produced by one or more motors, with microsecond
+ * timing, for comparing motion across library versions, boards or configurations.
+ *
+ * Events are kept in a caller supplied ring buffer, one per STEP pulse:
+ *   uint16 dt      micros since the previous event
+ *   uint8  flags   STEP_RECORDER_DIR (DIR level), motor id << STEP_RECORDER_ID_SHIFT,
+ *                  STEP_RECORDER_GAP: no step, only adds dt (longer pauses)
+ *
+ * print() drains them as text lines "<dt> <motor> <dir>", which
+ * extras/steptrace.py summarizes and compares on the host.
+ *
+ * Copyright (C)2026 Laurentiu Badea
+ *
+ * This file may be redistributed under the terms of the MIT license.
+ * A copy of this license has been included with this distribution in the file LICENSE.
+ */
+#ifndef STEP_RECORDER_H
+#define STEP_RECORDER_H
+#include <Arduino.h>
+
+// event flags
+#define STEP_RECORDER_DIR 0x01
+#define STEP_RECORDER_ID_SHIFT 1
+#define STEP_RECORDER_ID_MASK 0x0E
+#define STEP_RECORDER_GAP 0x80
+
+/*
+ * Step recorder class.
+ * Attach it to motors with BasicStepperDriver::setRecorder(); the stepping path
+ * adds an event per step and the loop drains them with read() or print().
+ * One writer (the stepping path, possibly a timer interrupt) and one reader: only the
+ * writer moves head and counts lost events, only the reader moves tail. On AVR the
+ * reader accesses the shared counters with interrupts off, as they take several
+ * instructions there.
+ */
+class StepRecorder {
+public:
+    struct Event {
+        uint16_t dt;
+        uint8_t flags;
+    };
+
+protected:
+    Event* buffer;
+    unsigned short size;
+    volatile unsigned short head = 0;   // next event written
+    volatile unsigned short tail = 0;   // next event read
+    unsigned long last_time;
+    bool started = false;
+    // events not recorded because the buffer was full
+    volatile unsigned long lost = 0;
+    // lost events already reported by print()
+    unsigned long lost_reported = 0;
+    // time carried over from gap events by print()
+    unsigned long pending_dt = 0;
+
+    bool put(uint16_t dt, uint8_t flags);
+    // reader side access to the writer's counters
+    unsigned short readHead(void);
+    unsigned long readLost(void);
+
+public:
+    /*
+     * Record into <buffer>, an array of <size> events that must stay valid while
+     * recording. One slot is kept free, so it holds up to size-1 events.
+     */
+    StepRecorder(Event* buffer, unsigned short size)
+    :buffer(buffer), size(size)
+    {};
+    /*
+     * Discard all events and the lost count; the next step is recorded with dt 0
+     */
+    void clear(void);
+    /*
+     * Add a step at time <now> (micros). Called by the motors.
+     */
+    void record(unsigned long now, uint8_t flags);
+    unsigned short available(void){
+        short count = readHead() - tail;
+        return (count < 0) ? count + size : count;
+    }
+    bool read(Event& event);
+    /*
+     * Drain up to <max> events as text lines, returns the number of steps written.
+     * Events lost since the last print(), if any, are reported as a "# lost <count>" line.
+     */
+    unsigned short print(Print& out, unsigned short max=0xFFFF);
+    /*
+     * Events lost since clear()
+     */
+    unsigned long getLost(void){
+        return readLost();
+    }
+};
+#endif // STEP_RECORDER_H
@@ -0,0 +1,62 @@
+/*
+ * Single-timer step scheduler for any number of motors
+ *
+ * Copyright (C)2026 Laurentiu Badea
+ *
+ * This file may be redistributed under the terms of the MIT license.
+ * A copy of this license has been included with this distribution in the file LICENSE.
+ */
+#include "StepScheduler.h"
+
+unsigned long StepScheduler::service(unsigned long now){
+    while (true){
+        // fire the steps that are due, on motors with coincident deadlines together
+        bool running = false;
+        for (unsigned short i = 0; i < count; i++){
+            if (motors[i]->service(now)){
+                running = true;
+            }
+        }
+        if (!running){
+            return 0;
+        }
+        // earliest next deadline, from after the time spent stepping
+        now = micros();
+        unsigned long next = 0;
+        bool found = false;
+        for (unsigned short i = 0; i < count; i++){
+            if (motors[i]->getStepsRemaining() > 0){
+                unsigned long t = motors[i]->getTimeToNextAction(now);
+                if (!found || t < next){
+                    next = t;
+                    found = true;
+                }
+            }
+        }
+        if (!found){
+            // the last steps were taken, finish the moves
+            continue;
+        }
+        if (next > window){
+            return next;
+        }
+        BasicStepperDriver::delayMicros(next, now);
+        now = micros();
+    }
+}
+
+void StepScheduler::run(void){
+    unsigned long next;
+    while ((next = service(micros()))){
+        BasicStepperDriver::delayMicros(next);
+    }
+}
+
+bool StepScheduler::isRunning(void){
+    for (unsigned short i = 0; i < count; i++){
+        if (motors[i]->getStepsRemaining() > 0){
+            return true;
+        }
+    }
+    return false;
+}
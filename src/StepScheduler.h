@@ -0,0 +1,58 @@
+/*
+ * Single-timer step scheduler for any number of motors
+ *
+ * Copyright (C)2026 Laurentiu Badea
+ *
+ * This file may be redistributed under the terms of the MIT license.
+ * A copy of this license has been included with this distribution in the file LICENSE.
+ */
+#ifndef STEP_SCHEDULER_H
+#define STEP_SCHEDULER_H
+#include <Arduino.h>
+#include "BasicStepperDriver.h"
+
+/*
+ * Step scheduler class.
+ * Runs the moves of a list of motors from one timer (or loop): each service() call
+ * fires every step that is due, and returns the time until the earliest next one, for
+ * programming the timer. Each motor keeps its own absolute step deadlines, so the
+ * motors do not disturb each other's timing beyond the time spent stepping.
+ * Unlike MultiDriver there is no limit on the number of motors and no group move;
+ * moves are started on the motors themselves (startMove(), also with segments).
+ */
+class StepScheduler {
+protected:
+    BasicStepperDriver* const *motors;
+    unsigned short count;
+    // steps due within this time (micros) are waited for instead of returned
+    unsigned short window = 8;
+
+public:
+    /*
+     * Schedule the <count> motors in <motors>, an array that must stay valid
+     */
+    StepScheduler(BasicStepperDriver* const motors[], unsigned short count)
+    :motors(motors), count(count)
+    {};
+    /*
+     * Steps due within <window> micros are fired in the same call instead of returning.
+     * Set it to at least the time it takes to get back into service() (the timer
+     * interrupt latency), so short waits do not overrun.
+     */
+    void setWindow(unsigned short window){
+        this->window = window;
+    }
+    /*
+     * Fire all the steps that are due and return the time to the next one (micros),
+     * 0 when all motors are stopped. Call it from a timer interrupt programmed for
+     * the returned time, or from the loop.
+     * When called from an interrupt, start moves while it is disabled or not running.
+     */
+    unsigned long service(unsigned long now);
+    /*
+     * Run all moves to completion (blocking)
+     */
+    void run(void);
+    bool isRunning(void);
+};
+#endif // STEP_SCHEDULER_H
@@ -0,0 +1,158 @@
+/*
+ * Dedicated stepping task for a motor group
+ *
+ * Copyright (C)2026 Laurentiu Badea
+ *
+ * This file may be redistributed under the terms of the MIT license.
+ * A copy of this license has been included with this distribution in the file LICENSE.
+ */
+#include "StepperTask.h"
+
+#ifdef STEPPER_TASK_SUPPORTED
+
+/*
+ * Start the stepping task
+ */
+bool StepperTask::begin(short core, short priority){
+    if (started){
+        return true;
+    }
+    quit = false;
+    exited = false;
+#if defined(STEPPER_TASK_STD_THREAD)
+    (void)core;
+    (void)priority;
+    thread = std::thread(taskEntry, this);
+    started = true;
+#else
+    started = xTaskCreatePinnedToCore(taskEntry, "StepperTask", 4096, this,
+                                      priority, &handle, core) == pdPASS;
+#endif
+    return started;
+}
+
+void StepperTask::end(void){
+    if (!started){
+        return;
+    }
+    stop();
+    quit = true;
+#if defined(STEPPER_TASK_STD_THREAD)
+    thread.join();
+#else
+    // the task deletes itself after setting exited; its handle may be freed any time
+    // after that, so it is never used to wait
+    while (!exited){
+        vTaskDelay(1);
+    }
+    handle = nullptr;
+#endif
+    // the task is gone, clear what it left unconsumed
+    commands.clear();
+    stop_request = false;
+    brake_request = false;
+    started = false;
+}
+
+void StepperTask::taskEntry(void* arg){
+    StepperTask* task = static_cast<StepperTask*>(arg);
+    task->taskLoop();
+    // last access to the object, end() may return and destroy it from here on
+    task->exited = true;
+#if !defined(STEPPER_TASK_STD_THREAD)
+    vTaskDelete(NULL);
+#endif
+}
+
+/*
+ * Step as long as there is work, sleep when idle or when the next step is far enough away
+ */
+void StepperTask::taskLoop(void){
+    while (!quit){
+        poll(micros());
+        if (!moving || group.getTimeToNextAction(micros()) > STEPPER_TASK_SLEEP_MICROS){
+#if defined(STEPPER_TASK_STD_THREAD)
+            std::this_thread::sleep_for(std::chrono::microseconds(STEPPER_TASK_SLEEP_MICROS/2));
+#else
+            vTaskDelay(1);
+#endif
+        }
+    }
+    group.stop();
+    moving = false;
+}
+
+/*
+ * Consumer side: apply urgent requests, fire due steps, and start the next queued
+ * move once the group is idle.
+ */
+void StepperTask::poll(unsigned long now){
+    if (stop_request.exchange(false)){
+        group.stop();
+        commands.clear();
+    }
+    if (brake_request.exchange(false)){
+        group.startBrake();
+    }
+    bool active = group.service(now);
+    const Command* command;
+    while (!active && (command = commands.front())){
+        // publish before dequeuing so isRunning() never sees an empty queue and no move
+        moving = true;
+        switch (command->type){
+        case MOVE:
+            group.startMove(command->steps[0], command->steps[1], command->steps[2]);
+            active = true;
+            break;
+        case SET_RPM:
+            group.setRPM(command->rpm);
+            break;
+        case ENABLE:
+            group.enable();
+            break;
+        case DISABLE:
+            group.disable();
+            break;
+        }
+        Command done;
+        commands.pop(done);
+    }
+    moving = active;
+}
+
+/*
+ * Producer side
+ */
+bool StepperTask::send(const Command& command){
+    return commands.push(command);
+}
+
+bool StepperTask::startMove(steps_t steps1, steps_t steps2, steps_t steps3){
+    return send(Command{MOVE, {steps1, steps2, steps3}, 0});
+}
+
+bool StepperTask::setRPM(float rpm){
+    return send(Command{SET_RPM, {0, 0, 0}, rpm});
+}
+
+bool StepperTask::enable(void){
+    return send(Command{ENABLE, {0, 0, 0}, 0});
+}
+
+bool StepperTask::disable(void){
+    return send(Command{DISABLE, {0, 0, 0}, 0});
+}
+
+void StepperTask::startBrake(void){
+    brake_request = true;
+}
+
+void StepperTask::stop(void){
+    stop_request = true;
+}
+
+bool StepperTask::isRunning(void){
+    return !commands.isEmpty() || moving || stop_request;
+}
+
+#endif // STEPPER_TASK_SUPPORTED
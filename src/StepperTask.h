@@ -0,0 +1,169 @@
+/*
+ * Dedicated stepping task for a motor group
+ * Runs a MultiDriver/SyncDriver on its own task (pinned to one core on ESP32)
+ * and accepts commands from the application through a lock-free mailbox.
+ *
+ * Only available on ESP32 (FreeRTOS), or on any host with std::thread when
+ * STEPPER_TASK_STD_THREAD is defined (the host tests in test/test_stepper_task use it).
+ *
+ * Copyright (C)2026 Laurentiu Badea
+ *
+ * This file may be redistributed under the terms of the MIT license.
+ * A copy of this license has been included with this distribution in the file LICENSE.
+ */
+#ifndef STEPPER_TASK_H
+#define STEPPER_TASK_H
+#include <Arduino.h>
+#include "MultiDriver.h"
+
+#if defined(ARDUINO_ARCH_ESP32) || defined(STEPPER_TASK_STD_THREAD)
+#define STEPPER_TASK_SUPPORTED
+#include <atomic>
+#if defined(STEPPER_TASK_STD_THREAD)
+#include <thread>
+#endif
+
+// command mailbox depth, must be a power of 2
+#define STEPPER_TASK_QUEUE_SIZE 16
+// sleep instead of spinning when the next step is further away than this (micros)
+#define STEPPER_TASK_SLEEP_MICROS 2000
+
+/*
+ * Single-producer/single-consumer lock-free ring buffer.
+ * push() may only be called from one thread and pop()/front()/clear() from one other.
+ */
+template<typename T, unsigned N>
+class SPSCQueue {
+protected:
+    T items[N];
+    std::atomic<unsigned> head{0};    // next slot to write, owned by producer
+    std::atomic<unsigned> tail{0};    // next slot to read, owned by consumer
+
+public:
+    bool push(const T& item){
+        unsigned h = head.load(std::memory_order_relaxed);
+        if (h - tail.load(std::memory_order_acquire) == N){
+            return false;   // full
+        }
+        items[h & (N-1)] = item;
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+    /*
+     * Return the oldest item without removing it, or nullptr if empty
+     */
+    const T* front(void){
+        unsigned t = tail.load(std::memory_order_relaxed);
+        if (t == head.load(std::memory_order_acquire)){
+            return nullptr;
+        }
+        return &items[t & (N-1)];
+    }
+    bool pop(T& item){
+        const T* f = front();
+        if (!f){
+            return false;
+        }
+        item = *f;
+        tail.store(tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        return true;
+    }
+    /*
+     * Discard all queued items (consumer side)
+     */
+    void clear(void){
+        tail.store(head.load(std::memory_order_acquire), std::memory_order_release);
+    }
+    bool isEmpty(void){
+        return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire);
+    }
+};
+
+/*
+ * Stepping task class.
+ * After begin() the task owns the motor group: the application must only use the
+ * StepperTask methods, not the group or the motors directly.
+ */
+class StepperTask {
+public:
+    enum CommandType {MOVE, SET_RPM, ENABLE, DISABLE};
+    struct Command {
+        CommandType type;
+        steps_t steps[3];
+        float rpm;
+    };
+
+protected:
+    MultiDriver& group;
+    SPSCQueue<Command, STEPPER_TASK_QUEUE_SIZE> commands;
+    // brake/stop bypass the queue so they are not held up behind pending moves
+    std::atomic<bool> brake_request{false};
+    std::atomic<bool> stop_request{false};
+    // a move is in progress or being started (published by the task)
+    std::atomic<bool> moving{false};
+    std::atomic<bool> quit{false};
+    // set by the task as its last access to this object, before it is deleted
+    std::atomic<bool> exited{false};
+    bool started = false;
+#if defined(STEPPER_TASK_STD_THREAD)
+    std::thread thread;
+#else
+    TaskHandle_t handle = nullptr;
+#endif
+    static void taskEntry(void* arg);
+    void taskLoop(void);
+    bool send(const Command& command);
+
+public:
+    StepperTask(MultiDriver& group)
+    :group(group)
+    {};
+    ~StepperTask(){
+        end();
+    }
+    /*
+     * Start the stepping task.
+     * On ESP32 it is pinned to <core>; the Arduino loop() runs on core 1.
+     * Continuous stepping on core 0 starves the idle task, so long moves there may
+     * need the task watchdog relaxed (disableCore0WDT()).
+     */
+    bool begin(short core=0, short priority=1);
+    /*
+     * Stop the stepping task. Any move in progress is stopped immediately and the
+     * queued commands are discarded; begin() starts again from an empty queue.
+     */
+    void end(void);
+    /*
+     * Queue a move (see MultiDriver::startMove). It starts when the previous one completes.
+     * Returns false if the mailbox is full.
+     */
+    bool startMove(steps_t steps1, steps_t steps2, steps_t steps3=0);
+    /*
+     * Queue a speed change for all motors, effective from the next queued move.
+     */
+    bool setRPM(float rpm);
+    /*
+     * Queue turning all motors on or off
+     */
+    bool enable(void);
+    bool disable(void);
+    /*
+     * Begin braking the current move early. Queued moves still run afterwards.
+     */
+    void startBrake(void);
+    /*
+     * Stop the current move immediately and discard all queued commands.
+     */
+    void stop(void);
+    /*
+     * True while a move is in progress or queued
+     */
+    bool isRunning(void);
+    /*
+     * One iteration of the stepping loop: apply pending commands and fire due steps.
+     * Called by the task; only call it directly if the task was not started.
+     */
+    void poll(unsigned long now);
+};
+#endif // ARDUINO_ARCH_ESP32 || STEPPER_TASK_STD_THREAD
+#endif // STEPPER_TASK_H
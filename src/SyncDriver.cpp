@@ -14,14 +14,19 @@
 /*
  * Initialize motor parameters
  */
-void SyncDriver::startMove(long steps1, long steps2, long steps3){
-    long steps[3] = {steps1, steps2, steps3};
+void SyncDriver::startMove(steps_t steps1, steps_t steps2, steps_t steps3){
+    steps_t steps[3] = {steps1, steps2, steps3};
+    if (feed_pending){
+        // not applied to the last move, plan this one with it
+        feed_pending = false;
+        MultiDriver::setFeedOverride(feed_factor);
+    }
     /*
      * find which motor would take the longest to finish,
      */
-    long move_time = 0;
+    move_time_t move_time = 0;
     FOREACH_MOTOR(
-        long m = motors[i]->getTimeForMove(labs(steps[i]));
+        move_time_t m = (i != gear_slave) ? motors[i]->getTimeForMove((steps[i] >= 0) ? steps[i] : -steps[i]) : 0;
         if (m > move_time){
             move_time = m;
         }
@@ -30,7 +35,7 @@ void SyncDriver::startMove(long steps1, long steps2, long steps3){
      * Initialize state for all active motors to complete with <move_time> micros
      */
     FOREACH_MOTOR(
-        if (steps[i]){
+        if (steps[i] && i != gear_slave){
             motors[i]->startMove(steps[i], move_time);
             event_timers[i] = 1;
         } else {
@@ -38,6 +43,234 @@ void SyncDriver::startMove(long steps1, long steps2, long steps3){
        }
     );
     ready = false;
-    last_action_end = 0;
+    last_action_due = 0;
     next_action_interval = 1;
 }
+
+/*
+ * Feed override: the change waits until all the moving motors cruise, so they start
+ * it together from speeds in proportion to their steps left (see applyFeedOverride())
+ */
+void SyncDriver::setFeedOverride(float factor){
+    feed_factor = factor;
+    feed_pending = true;
+    applyFeedOverride();
+}
+/*
+ * The motor with the most steps left sets the speed, and the others follow it in
+ * proportion to their steps left, with its acceleration and deceleration scaled the
+ * same way, so they all keep arriving at the same time
+ */
+void SyncDriver::applyFeedOverride(void){
+    short lead = -1;
+    FOREACH_MOTOR(
+        if (event_timers[i] && motors[i]->getStepsRemaining() > 0){
+            if (motors[i]->getCurrentState() != Motor::CRUISING || !motors[i]->canChangeSpeed()){
+                return;
+            }
+            if (lead < 0 || motors[i]->getStepsRemaining() > motors[lead]->getStepsRemaining()){
+                lead = i;
+            }
+        }
+    );
+    feed_pending = false;
+    MultiDriver::setFeedOverride(feed_factor);
+    if (lead < 0){
+        return;
+    }
+    Motor& leader = *motors[lead];
+    // microsteps per minute
+    float speed = leader.getCruiseRPM() * leader.getSteps() * leader.getMicrostep();
+    FOREACH_MOTOR(
+        if (i != lead && event_timers[i] && motors[i]->getStepsRemaining() > 0){
+            float ratio = (float)motors[i]->getStepsRemaining() / leader.getStepsRemaining();
+            motors[i]->changeSpeed(speed * ratio / motors[i]->getSteps() / motors[i]->getMicrostep(),
+                                   ratio * leader.getAcceleration() / motors[i]->getAcceleration(),
+                                   ratio * leader.getDeceleration() / motors[i]->getDeceleration());
+        }
+    );
+}
+
+/*
+ * Set up an arc: the number of midpoint iterations (steps of the axis moving faster
+ * at each point) is the length of the profile run by the first motor.
+ */
+bool SyncDriver::startArc(long x, long y, long i, long j, bool clockwise){
+    float r = sqrt((float)i * i + (float)j * j);
+    float r_end = sqrt((float)(x - i) * (x - i) + (float)(y - j) * (y - j));
+    // the end point is reached by single steps from where the arc ends, keep that short
+    if (r >= 32000 || fabs(r_end - r) > ARC_TOLERANCE){
+        return false;
+    }
+    arc_x = -i;
+    arc_y = -j;
+    arc_end_x = x - i;
+    arc_end_y = y - j;
+    arc_error = 0;
+    arc_clockwise = clockwise;
+    if (feed_pending){
+        feed_pending = false;
+        MultiDriver::setFeedOverride(feed_factor);
+    }
+
+    float start = atan2(arc_y, arc_x);
+    float sweep = atan2(arc_end_y, arc_end_x) - start;
+    if (clockwise){
+        sweep = -sweep;
+    }
+    if (sweep <= 0){
+        sweep += 2 * PI;    // includes the full circle
+    }
+    // count per octant: |delta y| where x is larger, |delta x| where y is larger
+    float direction = (clockwise) ? -1 : 1;
+    float a = start;
+    float iterations = 0;
+    while (sweep > 0){
+        // distance to the next octant boundary, never 0 when starting on one
+        float piece = (direction > 0)
+            ? (floor(a / (PI/4) + 1e-3) + 1) * (PI/4) - a
+            : a - (ceil(a / (PI/4) - 1e-3) - 1) * (PI/4);
+        if (piece > sweep){
+            piece = sweep;
+        }
+        float b = a + direction * piece;
+        float middle = (a + b) / 2;
+        if (fabs(cos(middle)) >= fabs(sin(middle))){
+            iterations += r * fabs(sin(b) - sin(a));
+        } else {
+            iterations += r * fabs(cos(b) - cos(a));
+        }
+        sweep -= piece;
+        a = b;
+    }
+    arc_steps = lround(iterations);
+
+    FOREACH_MOTOR(event_timers[i] = 0);
+    // both motors step, wake them (auto power) and schedule the first step after that
+    short wakeup0 = motors[0]->wake();
+    short wakeup1 = motors[1]->wake();
+    motors[0]->startMove(arc_steps);
+    event_timers[0] = 1;    // so startBrake() and stop() reach the profile
+    ready = (arc_steps == 0);
+    last_action_due = micros();
+    next_action_interval = (wakeup0 > wakeup1) ? wakeup0 : wakeup1;
+    return true;
+}
+
+bool SyncDriver::arc(long x, long y, long i, long j, bool clockwise){
+    if (!startArc(x, y, i, j, clockwise)){
+        return false;
+    }
+    while (!ready){
+        nextAction();
+    }
+    return true;
+}
+
+/*
+ * One midpoint circle iteration: a step on the axis moving faster, plus a step on the
+ * other axis if that keeps closer to the circle
+ */
+void SyncDriver::arcStep(void){
+    // absolute schedule like the motors' own (see BasicStepperDriver::emitStep())
+    unsigned long start = micros();
+    unsigned long due = last_action_due + next_action_interval;
+    if (!last_action_due || start - due >= next_action_interval){
+        due = start;
+    }
+    long interval = motors[0]->nextProfileStep();
+    if (!interval){
+        // stopped or braked early
+        arc_steps = 0;
+    }
+    if (arc_steps > 0){
+        bool x_major = labs(arc_y) > labs(arc_x);
+        // tangent is (-y, x) counterclockwise
+        int major = (x_major) ? ((arc_y > 0) ? -1 : 1) : ((arc_x > 0) ? 1 : -1);
+        if (arc_clockwise){
+            major = -major;
+        }
+        long minor_pos = (x_major) ? arc_y : arc_x;
+        long error = arc_error + ((x_major) ? 2 * arc_x * major : 2 * arc_y * major) + 1;
+        // candidate errors for no minor step, minor step up, minor step down
+        long up = error + 2 * minor_pos + 1;
+        long down = error - 2 * minor_pos + 1;
+        int minor = 0;
+        if (labs(up) < labs(error) && labs(up) <= labs(down)){
+            minor = 1;
+            error = up;
+        } else if (labs(down) < labs(error)){
+            minor = -1;
+            error = down;
+        }
+        arc_error = error;
+        short major_motor = (x_major) ? 0 : 1;
+        motors[major_motor]->step(major);
+        if (x_major){
+            arc_x += major;
+            arc_y += minor;
+        } else {
+            arc_y += major;
+            arc_x += minor;
+        }
+        if (minor){
+            motors[1 - major_motor]->step(minor);
+            // diagonal step is sqrt(2) longer
+            interval = (interval * 181) >> 7;
+        }
+        arc_steps--;
+        if (!arc_steps){
+            // land exactly on the end point
+            for (; arc_x != arc_end_x; arc_x += (arc_end_x > arc_x) ? 1 : -1){
+                motors[0]->step((arc_end_x > arc_x) ? 1 : -1);
+            }
+            for (; arc_y != arc_end_y; arc_y += (arc_end_y > arc_y) ? 1 : -1){
+                motors[1]->step((arc_end_y > arc_y) ? 1 : -1);
+            }
+            motors[0]->stop();
+        }
+    }
+    last_action_due = due;
+    next_action_interval = (arc_steps > 0) ? interval : 0;
+    if (!arc_steps){
+        event_timers[0] = 0;
+        ready = true;
+    }
+}
+
+long SyncDriver::nextAction(void){
+    if (!arc_steps){
+        MultiDriver::nextAction();
+    } else {
+        Motor::delayMicros(next_action_interval, last_action_due);
+        arcStep();
+    }
+    if (feed_pending){
+        applyFeedOverride();
+    }
+    return next_action_interval;
+}
+
+bool SyncDriver::service(unsigned long now){
+    bool running;
+    if (!arc_steps){
+        running = MultiDriver::service(now);
+    } else {
+        if (now - last_action_due >= next_action_interval){
+            arcStep();
+        }
+        running = arc_steps > 0;
+    }
+    if (feed_pending){
+        applyFeedOverride();
+    }
+    return running;
+}
+
+unsigned long SyncDriver::getTimeToNextAction(unsigned long now){
+    if (!arc_steps){
+        return MultiDriver::getTimeToNextAction(now);
+    }
+    unsigned long elapsed = now - last_action_due;
+    return (elapsed >= next_action_interval) ? 0 : next_action_interval - elapsed;
+}
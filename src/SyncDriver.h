@@ -12,6 +12,11 @@
 #include <Arduino.h>
 #include "MultiDriver.h"
 
+// how far (steps) the end point of an arc may be off its circle
+#ifndef ARC_TOLERANCE
+#define ARC_TOLERANCE 2
+#endif
+
 /*
  * Synchronous Multi-motor group driver class.
  * This driver sets up timing so all motors reach their target at the same time.
@@ -19,8 +24,49 @@
 class SyncDriver : public MultiDriver {
     using MultiDriver::MultiDriver;
 
+protected:
+    /*
+     * Arc in progress on motors 0 and 1, position relative to the center
+     */
+    long arc_x;
+    long arc_y;
+    long arc_error;         // x^2 + y^2 - r^2
+    long arc_steps = 0;     // iterations left
+    long arc_end_x;
+    long arc_end_y;
+    bool arc_clockwise;
+    void arcStep(void);
+
+    /*
+     * Feed override waiting for all the motors to cruise
+     */
+    bool feed_pending = false;
+    float feed_factor;
+    void applyFeedOverride(void);
+
 public:
 
-    void startMove(long steps1, long steps2, long steps3=0) override;
+    void startMove(steps_t steps1, steps_t steps2, steps_t steps3=0) override;
+    /*
+     * Circular arc on motors 0 (X) and 1 (Y), G2/G3 style: end point (x, y) and center
+     * (i, j) are in steps relative to the current position; end = start for a full circle.
+     * Steps are generated incrementally (midpoint circle, integer math, constant cost per
+     * step) and timed by the first motor's RPM and speed profile as the tangential speed.
+     * Both motors need the same steps per unit, and the radius must be under 32000 steps.
+     * Returns false, without moving, if the radius is too large or the end point is more
+     * than ARC_TOLERANCE steps off the circle.
+     */
+    bool startArc(long x, long y, long i, long j, bool clockwise);
+    bool arc(long x, long y, long i, long j, bool clockwise);
+    /*
+     * Feed override that keeps the motors synchronized: it is applied once all the
+     * moving motors cruise, and from then on they move in proportion to the one with
+     * the most steps left. Moves that never cruise again keep their speeds, and the
+     * override applies from the next move.
+     */
+    void setFeedOverride(float factor) override;
+    long nextAction(void) override;
+    bool service(unsigned long now) override;
+    unsigned long getTimeToNextAction(unsigned long now) override;
 };
 #endif // SYNC_DRIVER_H
@@ -6,6 +6,28 @@
  */
 #include "TMC2100.h"
 
+/*
+ * CFG1 CFG2 Microsteps Mode
+ * GND  GND  1          SpreadCycle
+ * VIO  GND  2          SpreadCycle
+ * OPEN GND  2          SpreadCycle
+ * GND  VIO  4          SpreadCycle
+ * VIO  VIO  16         SpreadCycle
+ * OPEN VIO  4          SpreadCycle
+ * GND  OPEN 8          SpreadCycle
+ * VIO  OPEN 16         StealthChop
+ * OPEN OPEN 16         StealthChop
+ *
+ * {0bCFG2,CFG1 levels, 0bCFG2,CFG1 driven} for 1,2,4,8,16 microsteps
+ */
+const PinGroup::State TMC2100::MS_TABLE[] = {
+    {0b00, 0b11}, {0b01, 0b11}, {0b10, 0b11}, {0b00, 0b01}, {0b01, 0b01}
+};
+/*
+ * OPEN GND: 1/2 step input interpolated to 1/256 microsteps
+ */
+const PinGroup::State TMC2100::INTERPOLATED_STATE = {0b00, 0b10};
+
 /*
  * Basic connection: only DIR, STEP are connected.
  * Microstepping controls should be hardwired.
@@ -33,14 +55,15 @@ cf1_pin(cf1_pin), cf2_pin(cf2_pin)
 { initTiming(); }
 
 void TMC2100::begin(float rpm, short microsteps){
-    BasicStepperDriver::begin(rpm, microsteps);
-
-    if (!IS_CONNECTED(cf1_pin) || !IS_CONNECTED(cf2_pin)){
-        return;
+    // precompute the CFG pin states so setMicrostep() changes all pins at once
+    ms_pins.begin(cf1_pin, cf2_pin);
+    if (ms_pins.isConnected()){
+        for (size_t i = 0; i < sizeof(MS_TABLE)/sizeof(*MS_TABLE); i++){
+            ms_states[i] = ms_pins.prepare(MS_TABLE[i].value, MS_TABLE[i].drive);
+        }
+        interpolated_state = ms_pins.prepare(INTERPOLATED_STATE.value, INTERPOLATED_STATE.drive);
     }
-
-    pinMode(cf1_pin, OUTPUT);
-    pinMode(cf2_pin, OUTPUT);
+    BasicStepperDriver::begin(rpm, microsteps);
 }
 
 /*
@@ -51,50 +74,75 @@ void TMC2100::begin(float rpm, short microsteps){
 short TMC2100::setMicrostep(short microsteps){
     BasicStepperDriver::setMicrostep(microsteps);
 
-    if (!IS_CONNECTED(cf1_pin) || !IS_CONNECTED(cf2_pin)){
+    if (!ms_pins.isConnected()){
         return this->microsteps;
     }
 
-    // CFG1 CFG2 Microsteps Mode
-    // GND  GND  1          SpreadCycle
-    // VIO  GND  2          SpreadCycle
-    // OPEN GND  2          SpreadCycle
-    // GND  VIO  4          SpreadCycle
-    // VIO  VIO  16         SpreadCycle
-    // OPEN VIO  4          SpreadCycle
-    // GND  OPEN 8          SpreadCycle
-    // VIO  OPEN 16         StealthChop
-    // OPEN OPEN 16         StealthChop
+    applyMicrostep();
+    setInterpolation(interpolation_rpm);
+    return this->microsteps;
+}
 
-    switch(this->microsteps){
-        case 1:
-            // GND, GND
-            pinMode(cf1_pin, OUTPUT); digitalWrite(cf1_pin, LOW);
-            pinMode(cf2_pin, OUTPUT); digitalWrite(cf2_pin, LOW);
-            break;
-        case 2:
-            // VIO, GND
-            pinMode(cf1_pin, OUTPUT); digitalWrite(cf1_pin, HIGH);
-            pinMode(cf2_pin, OUTPUT); digitalWrite(cf2_pin, LOW);
-            break;
-        case 4:
-            // GND, VIO
-            pinMode(cf1_pin, OUTPUT); digitalWrite(cf1_pin, LOW);
-            pinMode(cf2_pin, OUTPUT); digitalWrite(cf2_pin, HIGH);
-            break;
-        case 8:
-            // GND, OPEN
-            pinMode(cf1_pin, OUTPUT); digitalWrite(cf1_pin, LOW);
-            pinMode(cf2_pin, INPUT);
-            break;
-        case 16:
-            // VIO, OPEN (StealthChop)
-            pinMode(cf1_pin, OUTPUT); digitalWrite(cf1_pin, HIGH);
-            pinMode(cf2_pin, INPUT);
+void TMC2100::applyMicrostep(void){
+    for (size_t i = 0; i < sizeof(MS_TABLE)/sizeof(*MS_TABLE); i++){
+        if (this->microsteps & (1<<i)){
+            ms_pins.apply(ms_states[i]);
             break;
+        }
     }
+}
 
-    return this->microsteps;
+void TMC2100::setInterpolation(float rpm){
+    interpolation_rpm = rpm;
+    interpolation_pulse = 0;
+    if (rpm > 0 && ms_pins.isConnected() && microsteps > INTERPOLATED_MICROSTEP){
+        interpolation_pulse = STEP_PULSE(motor_steps, microsteps, rpm);
+        notify_state = true;
+    }
+}
+
+/*
+ * Switch the cruise section to interpolated steps and back.
+ * This runs before the STEP pulse, so the CFG pins are set up for the step being emitted.
+ * The chip keeps its microstep position across the change; each interpolated step moves
+ * <ratio> microsteps, which are accounted for through step_size.
+ */
+void TMC2100::stateChanged(enum State state){
+    if (state == CRUISING){
+        // step_pulse, not cruise_step_pulse: timed moves stretch the actual cruise pulse
+        if (step_size == 1 && step_pulse < interpolation_pulse){
+            short ratio = microsteps / INTERPOLATED_MICROSTEP;
+            steps_t coarse_steps = (steps_remaining - steps_to_brake) / ratio;
+            if (coarse_steps > 1){
+                interpolated_start = step_count;
+                interpolated_brake = steps_to_brake;
+                // the remainder is done in normal microsteps after the interpolated ones
+                steps_to_brake = interpolated_end = steps_remaining - coarse_steps * ratio;
+                step_size = ratio;
+                step_pulse *= ratio;
+                ms_pins.apply(interpolated_state);
+            }
+        }
+    } else if (step_size > 1){
+        short ratio = step_size;
+        step_size = 1;
+        applyMicrostep();
+        if (step_count >= interpolated_start && steps_to_brake == interpolated_end){
+            // same move and segment: restore the real braking point and cruise timing
+            steps_to_brake = interpolated_brake;
+            step_pulse /= ratio;
+        }
+    }
+}
+
+/*
+ * A cruise above the interpolation speed steps at the interpolated input level
+ */
+unsigned char TMC2100::cruiseStepSize(float rpm){
+    if (interpolation_pulse && STEP_PULSE(motor_steps, microsteps, rpm) < interpolation_pulse){
+        return microsteps / INTERPOLATED_MICROSTEP;
+    }
+    return 1;
 }
 
 short TMC2100::getMaxMicrostep(){
@@ -8,11 +8,16 @@
 #define TMC2100_H
 #include <Arduino.h>
 #include "BasicStepperDriver.h"
+#include "PinGroup.h"
 
 class TMC2100 : public BasicStepperDriver {
 protected:
     short cf1_pin = PIN_UNCONNECTED;
     short cf2_pin = PIN_UNCONNECTED;
+    static const PinGroup::State MS_TABLE[];
+    // CFG pins and their precomputed states for each microstep level
+    PinGroup ms_pins;
+    PinGroup::State ms_states[PIN_GROUP_MAX_STATES];
     // Set timing requirements from TMC2100 datasheet
     void initTiming(){
         // tA STEP HIGH pulse duration, min value (1us)
@@ -26,10 +31,29 @@ protected:
     // Get max microsteps supported by the device
     short getMaxMicrostep() override;
 
+    /*
+     * Interpolated high speed mode, see setInterpolation()
+     */
+    static const PinGroup::State INTERPOLATED_STATE;
+    PinGroup::State interpolated_state;
+    float interpolation_rpm = 0;
+    // cruise step pulse below which the interpolated mode is used, 0 = off
+    long interpolation_pulse = 0;
+    // step_count and steps_to_brake when the move switched to interpolated steps,
+    // and the braking point used meanwhile
+    steps_t interpolated_start;
+    steps_t interpolated_brake;
+    steps_t interpolated_end;
+    void applyMicrostep(void);
+    void stateChanged(enum State state) override;
+    unsigned char cruiseStepSize(float rpm) override;
+
 private:
     // microstep range (1, 2, 4, 8, 16)
     // maximum level controllable by CFG pins is 1/16, TMC2100 can interpolate to 1/256 internally
     static const short MAX_MICROSTEP = 16;
+    // input microstep level of the interpolated mode (CFG1 open, CFG2 GND)
+    static const short INTERPOLATED_MICROSTEP = 2;
 
 public:
     /*
@@ -47,5 +71,13 @@ public:
     TMC2100(short steps, short dir_pin, short step_pin, short cf1_pin, short cf2_pin);
     TMC2100(short steps, short dir_pin, short step_pin, short enable_pin, short cf1_pin, short cf2_pin);
     short setMicrostep(short microsteps) override;
+    /*
+     * High speed mode: cruise faster than <rpm> using 1/2 step input, which the chip
+     * interpolates to 1/256, so the STEP rate drops by microsteps/2 (8x at 1/16).
+     * Acceleration, deceleration and slower moves use the normal microstep level, and
+     * positions and step counts stay in those microsteps. 0 turns it off.
+     * Needs the CFG pins connected and a microstep level above 2.
+     */
+    void setInterpolation(float rpm);
 };
 #endif // TMC2100_H
@@ -0,0 +1,194 @@
+/*
+ * Minimal Arduino API for the host (native) unit tests
+ *
+ * Time is simulated: micros() advances by sim_cost on every call and the delays
+ * advance it directly, so the tests run fast and give the same results every time.
+ * Output pins count their rising edges, and the tests drive input pins with
+ * sim_input(), which fires the attached interrupt on a matching edge. sim_alarm_isr
+ * stands in for a timer interrupt at time sim_alarm.
+ *
+ * Copyright (C)2026 Laurentiu Badea
+ *
+ * This file may be redistributed under the terms of the MIT license.
+ * A copy of this license has been included with this distribution in the file LICENSE.
+ */
+#ifndef ARDUINO_H
+#define ARDUINO_H
+#include <stdint.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <atomic>
+
+#define HIGH 1
+#define LOW 0
+#define INPUT 0
+#define OUTPUT 1
+#define INPUT_PULLUP 2
+#define CHANGE 1
+#define FALLING 2
+#define RISING 3
+#define NOT_AN_INTERRUPT -1
+#define PI 3.1415926535897932384626433832795
+#define PROGMEM
+#define pgm_read_word(addr) (*(const uint16_t*)(addr))
+
+typedef uint8_t byte;
+
+#define SIM_PINS 64
+
+/*
+ * Simulated clock (micros), shared by all threads
+ */
+inline std::atomic<unsigned long> sim_now{1000};
+// time each micros() call takes
+inline unsigned long sim_cost = 1;
+
+/*
+ * Simulated timer interrupt: sim_alarm_isr runs once, from the first micros() call
+ * at or after sim_alarm (the library waits by polling micros(), so this is also
+ * within its delays)
+ */
+inline unsigned long sim_alarm;
+inline void (*sim_alarm_isr)(void) = nullptr;
+
+inline unsigned long micros(void){
+    unsigned long now = sim_now += sim_cost;
+    if (sim_alarm_isr && (long)(now - sim_alarm) >= 0){
+        void (*isr)(void) = sim_alarm_isr;
+        sim_alarm_isr = nullptr;
+        isr();
+    }
+    return now;
+}
+inline unsigned long millis(void){
+    return sim_now / 1000;
+}
+inline void delayMicroseconds(unsigned int us){
+    sim_now += us;
+}
+inline void delay(unsigned long ms){
+    sim_now += ms * 1000;
+}
+inline void yield(void){}
+
+/*
+ * Simulated pins
+ */
+inline int sim_pin[SIM_PINS];
+// rising edges written to each pin
+inline long sim_edges[SIM_PINS];
+// called after every digitalWrite(), e.g. to move a simulated encoder
+inline void (*sim_write_hook)(int pin, int value) = nullptr;
+inline void (*sim_isr[SIM_PINS])(void);
+inline int sim_isr_mode[SIM_PINS];
+
+inline void pinMode(int, int){}
+inline void digitalWrite(int pin, int value){
+    if (pin < 0 || pin >= SIM_PINS){
+        return;
+    }
+    value = value ? HIGH : LOW;
+    if (value && !sim_pin[pin]){
+        sim_edges[pin]++;
+    }
+    sim_pin[pin] = value;
+    if (sim_write_hook){
+        sim_write_hook(pin, value);
+    }
+}
+inline int digitalRead(int pin){
+    return (pin >= 0 && pin < SIM_PINS) ? sim_pin[pin] : LOW;
+}
+inline int digitalPinToInterrupt(int pin){
+    return (pin >= 0 && pin < SIM_PINS) ? pin : NOT_AN_INTERRUPT;
+}
+inline void attachInterrupt(int interrupt, void (*isr)(void), int mode){
+    sim_isr[interrupt] = isr;
+    sim_isr_mode[interrupt] = mode;
+}
+inline void detachInterrupt(int interrupt){
+    sim_isr[interrupt] = nullptr;
+}
+inline void noInterrupts(void){}
+inline void interrupts(void){}
+
+/*
+ * Drive an input pin from the test, firing its interrupt on a matching edge
+ */
+inline void sim_input(int pin, int value){
+    int old = sim_pin[pin];
+    sim_pin[pin] = value ? HIGH : LOW;
+    if (sim_isr[pin] && old != sim_pin[pin] &&
+        (sim_isr_mode[pin] == CHANGE || (sim_isr_mode[pin] == RISING) == (sim_pin[pin] == HIGH))){
+        sim_isr[pin]();
+    }
+}
+/*
+ * Reset all pins, edge counters and interrupts
+ */
+inline void sim_reset(void){
+    memset(sim_pin, 0, sizeof(sim_pin));
+    memset(sim_edges, 0, sizeof(sim_edges));
+    memset(sim_isr, 0, sizeof(sim_isr));
+    sim_write_hook = nullptr;
+    sim_alarm_isr = nullptr;
+}
+
+/*
+ * Print and Stream, as far as the library uses them
+ */
+class Print {
+public:
+    virtual size_t write(uint8_t c) = 0;
+    virtual ~Print(){}
+    size_t print(const char* s){
+        size_t n = 0;
+        while (*s){
+            n += write(*s++);
+        }
+        return n;
+    }
+    size_t print(char c){
+        return write(c);
+    }
+    size_t print(long value){
+        char buffer[24];
+        snprintf(buffer, sizeof(buffer), "%ld", value);
+        return print(buffer);
+    }
+    size_t print(unsigned long value){
+        char buffer[24];
+        snprintf(buffer, sizeof(buffer), "%lu", value);
+        return print(buffer);
+    }
+    size_t print(int value){
+        return print((long)value);
+    }
+    size_t print(unsigned int value){
+        return print((unsigned long)value);
+    }
+    size_t print(double value, int digits=2){
+        char buffer[32];
+        snprintf(buffer, sizeof(buffer), "%.*f", digits, value);
+        return print(buffer);
+    }
+    size_t println(void){
+        return write('\n');
+    }
+    template<typename T>
+    size_t println(T value){
+        size_t n = print(value);
+        return n + println();
+    }
+};
+
+class Stream : public Print {
+public:
+    virtual int available(void) = 0;
+    virtual int read(void) = 0;
+    virtual int peek(void) = 0;
+};
+#endif // ARDUINO_H
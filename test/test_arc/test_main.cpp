@@ -0,0 +1,125 @@
+/*
+ * SyncDriver arc host test: end points, refused arcs and auto power
+ *
+ * Copyright (C)2026 Laurentiu Badea
+ *
+ * This file may be redistributed under the terms of the MIT license.
+ * A copy of this license has been included with this distribution in the file LICENSE.
+ */
+#include <Arduino.h>
+#include <unity.h>
+#include "BasicStepperDriver.h"
+#include "SyncDriver.h"
+
+#define MOTOR_STEPS 200
+#define X_STEP 3
+#define Y_STEP 5
+#define X_ENABLE 8
+#define Y_ENABLE 9
+#define WAKEUP_TIME 1000
+
+/*
+ * Driver with a datasheet wakeup time, like the DRV8825 or TMC2100
+ */
+class SlowWakeDriver : public BasicStepperDriver {
+public:
+    SlowWakeDriver(short steps, short dir_pin, short step_pin, short enable_pin)
+    :BasicStepperDriver(steps, dir_pin, step_pin, enable_pin)
+    {
+        wakeup_time = WAKEUP_TIME;
+    }
+};
+
+SlowWakeDriver mx(MOTOR_STEPS, 2, X_STEP, X_ENABLE);
+SlowWakeDriver my(MOTOR_STEPS, 4, Y_STEP, Y_ENABLE);
+
+// time of the first STEP pulse on either motor, and whether a motor stepped while off
+unsigned long first_step;
+bool stepped_disabled;
+void recordSteps(int pin, int value){
+    if (value && (pin == X_STEP || pin == Y_STEP)){
+        if (!first_step){
+            first_step = sim_now;
+        }
+        if (!sim_pin[(pin == X_STEP) ? X_ENABLE : Y_ENABLE]){
+            stepped_disabled = true;
+        }
+    }
+}
+
+void setUp(void){
+    sim_reset();
+    mx.begin(120, 1);
+    my.begin(120, 1);
+    mx.setPosition(0);
+    my.setPosition(0);
+}
+
+void tearDown(void){
+    mx.setAutoPower(0);
+    my.setAutoPower(0);
+}
+
+void test_end_point(void){
+    SyncDriver group(mx, my);
+    // quarter circle, radius 100, center straight up
+    TEST_ASSERT_TRUE(group.arc(100, 100, 0, 100, false));
+    TEST_ASSERT_EQUAL(100, mx.getPosition());
+    TEST_ASSERT_EQUAL(100, my.getPosition());
+    // full circle clockwise back to the start
+    TEST_ASSERT_TRUE(group.arc(0, 0, -50, 0, true));
+    TEST_ASSERT_EQUAL(100, mx.getPosition());
+    TEST_ASSERT_EQUAL(100, my.getPosition());
+    // end point off the circle by a rounding error
+    TEST_ASSERT_TRUE(group.arc(71, 30, 0, 100, false));
+    TEST_ASSERT_EQUAL(171, mx.getPosition());
+    TEST_ASSERT_EQUAL(130, my.getPosition());
+}
+
+/*
+ * An end point off the circle would be reached with a burst of single steps at the end
+ */
+void test_off_circle(void){
+    SyncDriver group(mx, my);
+    TEST_ASSERT_FALSE(group.startArc(130, 0, 50, 0, false));
+    TEST_ASSERT_FALSE(group.arc(0, 400, 0, 100, true));
+    TEST_ASSERT_FALSE(group.arc(0, 0, 40000, 0, true));
+    TEST_ASSERT_FALSE(group.isRunning());
+    TEST_ASSERT_EQUAL(0, sim_edges[X_STEP]);
+    TEST_ASSERT_EQUAL(0, sim_edges[Y_STEP]);
+}
+
+/*
+ * Both motors are woken from auto power off, and stepping waits for the drivers
+ */
+void test_auto_power(void){
+    SyncDriver group(mx, my);
+    mx.setAutoPower(10);
+    my.setAutoPower(10);
+    mx.disable();
+    my.disable();
+    first_step = 0;
+    stepped_disabled = false;
+    sim_write_hook = recordSteps;
+
+    unsigned long start = micros();
+    TEST_ASSERT_TRUE(group.startArc(100, 100, 0, 100, false));
+    TEST_ASSERT_TRUE(mx.isEnabled());
+    TEST_ASSERT_TRUE(my.isEnabled());
+    while (group.service(micros()));
+
+    TEST_ASSERT_FALSE(stepped_disabled);
+    TEST_ASSERT_GREATER_OR_EQUAL(start + WAKEUP_TIME, first_step);
+    // not held up by a blocking wait either
+    TEST_ASSERT_LESS_THAN(start + WAKEUP_TIME + 100, first_step);
+    TEST_ASSERT_EQUAL(100, mx.getPosition());
+    TEST_ASSERT_EQUAL(100, my.getPosition());
+}
+
+int main(void){
+    UNITY_BEGIN();
+    RUN_TEST(test_end_point);
+    RUN_TEST(test_off_circle);
+    RUN_TEST(test_auto_power);
+    return UNITY_END();
+}
@@ -0,0 +1,109 @@
+/*
+ * Automatic power host test: the simulated ENABLE pins of single motors and groups
+ *
+ * Copyright (C)2026 Laurentiu Badea
+ *
+ * This file may be redistributed under the terms of the MIT license.
+ * A copy of this license has been included with this distribution in the file LICENSE.
+ */
+#include <Arduino.h>
+#include <unity.h>
+#include "BasicStepperDriver.h"
+#include "MultiDriver.h"
+
+#define MOTOR_STEPS 200
+#define ENABLE1 8
+#define ENABLE2 9
+
+BasicStepperDriver m1(MOTOR_STEPS, 2, 3, ENABLE1);
+BasicStepperDriver m2(MOTOR_STEPS, 4, 5, ENABLE2);
+
+void setUp(void){
+    sim_reset();
+    m1.begin(120, 1);
+    m2.begin(120, 1);
+}
+
+void tearDown(void){
+    m1.setAutoPower(0);
+    m2.setAutoPower(0);
+}
+
+// keep polling while stopped for the given time
+void idleFor(BasicStepperDriver& motor, unsigned long ms){
+    unsigned long start = millis();
+    while (millis() - start < ms){
+        motor.service(micros());
+        delayMicroseconds(500);
+    }
+}
+
+void test_single(void){
+    m1.setAutoPower(100);
+    m1.disable();
+    m1.startMove(20);
+    TEST_ASSERT_EQUAL(HIGH, sim_pin[ENABLE1]);
+    while (m1.service(micros()));
+    TEST_ASSERT_EQUAL(20, sim_edges[3]);
+    idleFor(m1, 90);
+    TEST_ASSERT_EQUAL(HIGH, sim_pin[ENABLE1]);
+    idleFor(m1, 20);
+    TEST_ASSERT_EQUAL(LOW, sim_pin[ENABLE1]);
+    TEST_ASSERT_FALSE(m1.isEnabled());
+}
+
+/*
+ * Idle times past the 71 minutes where micros() wraps on 32-bit boards
+ */
+void test_long_idle_time(void){
+    m1.setAutoPower(80UL * 60 * 1000);
+    m1.move(10);
+    m1.service(micros());
+    delay(79UL * 60 * 1000);
+    m1.service(micros());
+    TEST_ASSERT_TRUE(m1.isEnabled());
+    delay(2UL * 60 * 1000);
+    m1.service(micros());
+    TEST_ASSERT_FALSE(m1.isEnabled());
+}
+
+/*
+ * Group service() keeps checking the motors that are done while others still move,
+ * and all motors after the group move
+ */
+void test_group(void){
+    m1.setAutoPower(50);
+    m2.setAutoPower(50);
+    MultiDriver group(m1, m2);
+    // m1 is done after ~20ms, m2 after ~250ms
+    group.startMove(8, 100);
+    while (group.service(micros())){
+        delayMicroseconds(100);
+    }
+    TEST_ASSERT_FALSE(m1.isEnabled());
+    TEST_ASSERT_TRUE(m2.isEnabled());
+
+    unsigned long start = millis();
+    while (millis() - start < 60){
+        group.service(micros());
+        delayMicroseconds(500);
+    }
+    TEST_ASSERT_FALSE(m2.isEnabled());
+    TEST_ASSERT_EQUAL(LOW, sim_pin[ENABLE2]);
+
+    // the next group move wakes both
+    group.startMove(5, 5);
+    TEST_ASSERT_TRUE(m1.isEnabled());
+    TEST_ASSERT_TRUE(m2.isEnabled());
+    while (group.service(micros()));
+    TEST_ASSERT_EQUAL(13, sim_edges[3]);
+    TEST_ASSERT_EQUAL(105, sim_edges[5]);
+}
+
+int main(void){
+    UNITY_BEGIN();
+    RUN_TEST(test_single);
+    RUN_TEST(test_long_idle_time);
+    RUN_TEST(test_group);
+    return UNITY_END();
+}
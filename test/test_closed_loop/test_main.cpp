@@ -0,0 +1,134 @@
+/*
+ * Encoder feedback host test: a simulated quadrature encoder follows the motor's
+ * step pin through pin change interrupts, and can be made to miss steps.
+ *
+ * Copyright (C)2026 Laurentiu Badea
+ *
+ * This file may be redistributed under the terms of the MIT license.
+ * A copy of this license has been included with this distribution in the file LICENSE.
+ */
+#include <Arduino.h>
+#include <unity.h>
+#include "BasicStepperDriver.h"
+#include "ClosedLoop.h"
+
+#define MOTOR_STEPS 200
+#define DIR 8
+#define STEP 9
+#define ENC_A 20
+#define ENC_B 21
+// 4 counts per full step
+#define COUNTS_PER_REV 800
+
+BasicStepperDriver motor(MOTOR_STEPS, DIR, STEP);
+QuadratureEncoder encoder(ENC_A, ENC_B);
+
+long counts;            // simulated encoder position
+long steps;             // steps seen on the pins
+long lose_every;        // drop every nth step (0: none)
+long stall_after;       // drop all steps after this many (0: never)
+
+// A, B levels for counts 0..3, counting up
+const int GRAY[4] = {0b00, 0b10, 0b11, 0b01};
+
+void turn(int direction){
+    counts += direction;
+    int levels = GRAY[counts & 3];
+    sim_input(ENC_A, levels >> 1);
+    sim_input(ENC_B, levels & 1);
+}
+
+void encoderHook(int pin, int value){
+    if (pin != STEP || !value){
+        return;
+    }
+    steps++;
+    if ((lose_every && steps % lose_every == 0) || (stall_after && steps > stall_after)){
+        return;
+    }
+    int direction = (sim_pin[DIR] == HIGH) ? 1 : -1;
+    for (short i = 0; i < COUNTS_PER_REV / MOTOR_STEPS; i++){
+        turn(direction);
+    }
+}
+
+void setUp(void){
+    // the encoder keeps its interrupts across tests, so the pins are not reset
+    sim_input(ENC_A, LOW);
+    sim_input(ENC_B, LOW);
+    counts = 0;
+    steps = 0;
+    lose_every = 0;
+    stall_after = 0;
+    sim_write_hook = encoderHook;
+    motor.begin(120, 1);
+    motor.setPosition(0);
+    TEST_ASSERT_TRUE(encoder.begin());
+}
+
+void tearDown(void){}
+
+void test_encoder_counts(void){
+    encoder.write(0);
+    for (short i = 0; i < 10; i++){
+        turn(1);
+    }
+    TEST_ASSERT_EQUAL(10, encoder.read());
+    for (short i = 0; i < 25; i++){
+        turn(-1);
+    }
+    TEST_ASSERT_EQUAL(-15, encoder.read());
+    encoder.write(100);
+    turn(1);
+    TEST_ASSERT_EQUAL(101, encoder.read());
+}
+
+void test_follows(void){
+    ClosedLoop loop(motor, encoder, COUNTS_PER_REV);
+    loop.begin();
+    loop.move(400);
+    TEST_ASSERT_FALSE(loop.isStalled());
+    TEST_ASSERT_EQUAL(400, loop.getActualPosition());
+    TEST_ASSERT_LESS_OR_EQUAL(1, loop.getMaxFollowingError());
+    loop.move(-150);
+    TEST_ASSERT_EQUAL(250, loop.getActualPosition());
+}
+
+/*
+ * A few lost steps are made up at the end of the move
+ */
+void test_correction(void){
+    lose_every = 150;
+    ClosedLoop loop(motor, encoder, COUNTS_PER_REV);
+    loop.begin();
+    loop.move(400);
+    TEST_ASSERT_FALSE(loop.isStalled());
+    TEST_ASSERT_EQUAL(400, loop.getActualPosition());
+    TEST_ASSERT_EQUAL(400, motor.getPosition());
+    TEST_ASSERT_GREATER_THAN(400, steps);
+}
+
+/*
+ * A stalled motor is stopped and its position set to where it really is
+ */
+void test_stall(void){
+    stall_after = 100;
+    ClosedLoop loop(motor, encoder, COUNTS_PER_REV);
+    loop.begin();
+    loop.setLimits(1, 4, 1);
+    loop.move(400);
+    TEST_ASSERT_TRUE(loop.isStalled());
+    TEST_ASSERT_EQUAL(100, loop.getActualPosition());
+    TEST_ASSERT_EQUAL(100, motor.getPosition());
+    TEST_ASSERT_LESS_OR_EQUAL(106, steps);
+}
+
+int main(void){
+    sim_reset();
+    UNITY_BEGIN();
+    RUN_TEST(test_encoder_counts);
+    RUN_TEST(test_follows);
+    RUN_TEST(test_correction);
+    RUN_TEST(test_stall);
+    return UNITY_END();
+}
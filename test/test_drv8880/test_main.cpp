@@ -0,0 +1,101 @@
+/*
+ * DRV8880 current policy host test: the torque DAC level on the simulated TRQ pins
+ * through single, group and blocking moves
+ *
+ * Copyright (C)2026 Laurentiu Badea
+ *
+ * This file may be redistributed under the terms of the MIT license.
+ * A copy of this license has been included with this distribution in the file LICENSE.
+ */
+#include <Arduino.h>
+#include <unity.h>
+#include "DRV8880.h"
+#include "MultiDriver.h"
+
+#define MOTOR_STEPS 200
+#define TRQ0 10
+#define TRQ1 11
+
+DRV8880 stepper(MOTOR_STEPS, 2, 3, 8, 9, TRQ0, TRQ1);
+BasicStepperDriver other(MOTOR_STEPS, 4, 5);
+
+// current percent set by the TRQ pins
+short current(void){
+    return 100 - 25 * (sim_pin[TRQ0] + 2 * sim_pin[TRQ1]);
+}
+
+void setPolicy(unsigned long hold_timeout){
+    DRV8880::CurrentPolicy policy;
+    policy.cruise = 75;
+    policy.hold = 25;
+    policy.hold_timeout = hold_timeout;
+    stepper.setCurrentPolicy(policy);
+}
+
+void setUp(void){
+    sim_reset();
+    stepper.begin(120, 1);
+    other.begin(120, 1);
+}
+
+void tearDown(void){}
+
+void test_blocking_move(void){
+    setPolicy(0);
+    stepper.startMove(50);
+    for (short i = 0; i < 10; i++){
+        stepper.nextAction();
+    }
+    TEST_ASSERT_EQUAL(75, current());
+    while (stepper.nextAction());
+    TEST_ASSERT_EQUAL(25, current());
+
+    stepper.move(-50);
+    TEST_ASSERT_EQUAL(25, current());
+}
+
+void test_group_move(void){
+    setPolicy(0);
+    MultiDriver group(stepper, other);
+    // the DRV8880 finishes first and is not polled again while the other motor runs
+    group.startMove(20, 200);
+    bool checked = false;
+    while (group.service(micros())){
+        if (!checked && stepper.getCurrentState() == BasicStepperDriver::STOPPED){
+            TEST_ASSERT_EQUAL(25, current());
+            checked = true;
+        }
+    }
+    TEST_ASSERT_TRUE(checked);
+
+    group.move(-20, -200);
+    TEST_ASSERT_EQUAL(25, current());
+}
+
+/*
+ * The timeout counts from the last step, not from when the caller polls next
+ */
+void test_hold_timeout(void){
+    setPolicy(500);
+    stepper.startMove(50);
+    while (stepper.getCurrentState() != BasicStepperDriver::STOPPED){
+        stepper.nextAction();
+    }
+    unsigned long end = micros();
+    delay(450);
+    TEST_ASSERT_EQUAL(0, stepper.nextAction());
+    TEST_ASSERT_EQUAL(75, current());
+    while (micros() - end < 500000UL){
+        delayMicroseconds(100);
+    }
+    TEST_ASSERT_EQUAL(0, stepper.nextAction());
+    TEST_ASSERT_EQUAL(25, current());
+}
+
+int main(void){
+    UNITY_BEGIN();
+    RUN_TEST(test_blocking_move);
+    RUN_TEST(test_group_move);
+    RUN_TEST(test_hold_timeout);
+    return UNITY_END();
+}
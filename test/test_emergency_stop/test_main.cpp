@@ -0,0 +1,165 @@
+/*
+ * Emergency stop host test: the stop is raised from a simulated timer interrupt at
+ * points spread over the moves, and no STEP edge may follow it
+ *
+ * Copyright (C)2026 Laurentiu Badea
+ *
+ * This file may be redistributed under the terms of the MIT license.
+ * A copy of this license has been included with this distribution in the file LICENSE.
+ */
+#include <Arduino.h>
+#include <unity.h>
+#include "BasicStepperDriver.h"
+#include "MultiDriver.h"
+#include "SyncDriver.h"
+
+#define MOTOR_STEPS 200
+#define RPM 600
+#define STEPS 200
+// trigger points per test, moving through the step period
+#define TRIGGERS 20
+// a polling loop notices at its next service() call
+#define SERVICE_LATENCY 20
+
+const short STEP_PINS[3] = {3, 5, 7};
+
+BasicStepperDriver m1(MOTOR_STEPS, 2, 3);
+BasicStepperDriver m2(MOTOR_STEPS, 4, 5);
+BasicStepperDriver m3(MOTOR_STEPS, 6, 7);
+
+const long STEP_MICROS = STEP_PULSE(MOTOR_STEPS, 1, RPM);
+
+/*
+ * Time of the stop, and the STEP edges up to it
+ */
+unsigned long triggered;
+long edges_at_trigger;
+unsigned long last_edge;
+long worst_latency;
+
+long stepEdges(void){
+    return sim_edges[STEP_PINS[0]] + sim_edges[STEP_PINS[1]] + sim_edges[STEP_PINS[2]];
+}
+
+void stopISR(void){
+    BasicStepperDriver::emergencyStop();
+    triggered = sim_now;
+    edges_at_trigger = stepEdges();
+}
+
+void recordEdge(int pin, int value){
+    if (value && (pin == STEP_PINS[0] || pin == STEP_PINS[1] || pin == STEP_PINS[2])){
+        last_edge = sim_now;
+    }
+}
+
+void setUp(void){
+    sim_reset();
+    BasicStepperDriver::clearEmergencyStop();
+    m1.begin(RPM, 1);
+    m2.begin(RPM, 1);
+    m3.begin(RPM, 1);
+    worst_latency = 0;
+}
+
+void tearDown(void){
+    BasicStepperDriver::clearEmergencyStop();
+}
+
+/*
+ * Schedule the stop for trigger point <i>: later into the move each time, and a
+ * different phase of the step period
+ */
+void arm(short i){
+    BasicStepperDriver::clearEmergencyStop();
+    triggered = 0;
+    sim_write_hook = recordEdge;
+    sim_alarm = micros() + STEP_MICROS * (1 + 7 * i) + STEP_MICROS * i / TRIGGERS;
+    sim_alarm_isr = stopISR;
+}
+
+/*
+ * After the move loop returned at time <end>: no STEP edge was raised after the stop,
+ * and the loop noticed it within <bound> micros
+ */
+void check(unsigned long end, long bound){
+    TEST_ASSERT_TRUE(triggered != 0);
+    TEST_ASSERT_GREATER_THAN(0, edges_at_trigger);
+    TEST_ASSERT_EQUAL(edges_at_trigger, stepEdges());
+    TEST_ASSERT_TRUE((long)(last_edge - triggered) <= 0);
+    long latency = end - triggered;
+    worst_latency = (latency > worst_latency) ? latency : worst_latency;
+    TEST_ASSERT_LESS_OR_EQUAL(bound, latency);
+}
+
+void test_single_service(void){
+    for (short i = 0; i < TRIGGERS; i++){
+        arm(i);
+        m1.startMove(10 * STEPS);
+        while (m1.service(micros()));
+        check(micros(), SERVICE_LATENCY);
+        TEST_ASSERT_LESS_THAN(10 * STEPS, m1.getStepsCompleted());
+    }
+    printf("single service(): worst latency %ldus\n", worst_latency);
+}
+
+void test_multi_service(void){
+    MultiDriver group(m1, m2, m3);
+    for (short i = 0; i < TRIGGERS; i++){
+        arm(i);
+        group.startMove(10 * STEPS, -7 * STEPS, 5 * STEPS);
+        while (group.service(micros()));
+        check(micros(), SERVICE_LATENCY);
+        TEST_ASSERT_FALSE(group.isRunning());
+    }
+    printf("MultiDriver service(): worst latency %ldus\n", worst_latency);
+}
+
+/*
+ * The blocking loop sleeps until the next step is due, then drops it: at most one
+ * step period
+ */
+void test_multi_move(void){
+    MultiDriver group(m1, m2, m3);
+    for (short i = 0; i < TRIGGERS; i++){
+        arm(i);
+        group.move(10 * STEPS, -7 * STEPS, 5 * STEPS);
+        check(micros(), STEP_MICROS);
+    }
+    printf("MultiDriver move(): worst latency %ldus\n", worst_latency);
+}
+
+void test_sync_service(void){
+    SyncDriver group(m1, m2, m3);
+    for (short i = 0; i < TRIGGERS; i++){
+        arm(i);
+        group.startMove(10 * STEPS, -7 * STEPS, 5 * STEPS);
+        while (group.service(micros()));
+        check(micros(), SERVICE_LATENCY);
+        TEST_ASSERT_FALSE(group.isRunning());
+    }
+    printf("SyncDriver service(): worst latency %ldus\n", worst_latency);
+}
+
+/*
+ * New moves do not run until the stop is cleared
+ */
+void test_stays_stopped(void){
+    BasicStepperDriver::emergencyStop();
+    MultiDriver group(m1, m2, m3);
+    group.move(STEPS, STEPS, STEPS);
+    TEST_ASSERT_EQUAL(0, stepEdges());
+    BasicStepperDriver::clearEmergencyStop();
+    group.move(STEPS, STEPS, STEPS);
+    TEST_ASSERT_EQUAL(3 * STEPS, stepEdges());
+}
+
+int main(void){
+    UNITY_BEGIN();
+    RUN_TEST(test_single_service);
+    RUN_TEST(test_multi_service);
+    RUN_TEST(test_multi_move);
+    RUN_TEST(test_sync_service);
+    RUN_TEST(test_stays_stopped);
+    return UNITY_END();
+}
@@ -0,0 +1,96 @@
+/*
+ * Exact ramp start host test: step intervals of LINEAR_SPEED ramps compared with the
+ * ideal constant acceleration ones, t(n) = sqrt(2n/a).
+ *
+ * Copyright (C)2026 Laurentiu Badea
+ *
+ * This file may be redistributed under the terms of the MIT license.
+ * A copy of this license has been included with this distribution in the file LICENSE.
+ */
+#include <Arduino.h>
+#include <unity.h>
+#include "BasicStepperDriver.h"
+
+#define MOTOR_STEPS 200
+#define STEP 3
+#define RPM 300
+#define MAX_STEPS 8000
+// shorter intervals are dominated by the 1us timing resolution
+#define MIN_INTERVAL 100
+// measured bound for moves that reach cruise speed
+#define MAX_ERROR 0.02
+
+BasicStepperDriver motor(MOTOR_STEPS, 2, STEP);
+
+unsigned long times[MAX_STEPS];
+long count;
+
+void stepHook(int pin, int value){
+    if (pin == STEP && value && count < MAX_STEPS){
+        times[count++] = sim_now;
+    }
+}
+
+void setUp(void){
+    sim_reset();
+    count = 0;
+    sim_write_hook = stepHook;
+}
+
+void tearDown(void){}
+
+/*
+ * Worst relative error of the ramp intervals of a move with the given profile
+ */
+float rampError(short accel, short decel, short microsteps, long steps){
+    count = 0;
+    motor.begin(RPM, microsteps);
+    motor.setSpeedProfile(BasicStepperDriver::LINEAR_SPEED, accel, decel);
+    motor.setExactRamps(true);
+    motor.startMove(steps);
+    while (motor.service(micros()));
+    TEST_ASSERT_EQUAL(steps, count);
+
+    // ramp lengths [microsteps]
+    float speed = RPM * MOTOR_STEPS / 60.0;
+    long ramp_up = microsteps * speed * speed / (2.0 * accel);
+    long ramp_down = microsteps * speed * speed / (2.0 * decel);
+    // only moves that reach cruise speed
+    TEST_ASSERT_LESS_OR_EQUAL(steps, ramp_up + ramp_down);
+    float worst = 0;
+    for (long n = 1; n < ramp_up; n++){
+        // interval between steps n-1 and n from standstill
+        float ideal = 1e6 * (sqrt(2.0 * n / accel / microsteps) - sqrt(2.0 * (n-1) / accel / microsteps));
+        float error = (times[n] - times[n-1] - ideal) / ideal;
+        if (ideal > MIN_INTERVAL && fabs(error) > fabs(worst)){
+            worst = error;
+        }
+    }
+    for (long n = 1; n < ramp_down; n++){
+        // the last step is one interval before standstill
+        float ideal = 1e6 * (sqrt(2.0 * (n+1) / decel / microsteps) - sqrt(2.0 * n / decel / microsteps));
+        float error = (times[steps-n] - times[steps-n-1] - ideal) / ideal;
+        if (ideal > MIN_INTERVAL && fabs(error) > fabs(worst)){
+            worst = error;
+        }
+    }
+    return worst;
+}
+
+void test_full_step(void){
+    TEST_ASSERT_FLOAT_WITHIN(MAX_ERROR, 0, rampError(1000, 3000, 1, 1000));
+    TEST_ASSERT_FLOAT_WITHIN(MAX_ERROR, 0, rampError(500, 10000, 1, 1200));
+}
+
+void test_microsteps(void){
+    TEST_ASSERT_FLOAT_WITHIN(MAX_ERROR, 0, rampError(3000, 3000, 16, 8000));
+    TEST_ASSERT_FLOAT_WITHIN(MAX_ERROR, 0, rampError(10000, 10000, 16, 4000));
+    TEST_ASSERT_FLOAT_WITHIN(MAX_ERROR, 0, rampError(2000, 3000, 16, 8000));
+}
+
+int main(void){
+    UNITY_BEGIN();
+    RUN_TEST(test_full_step);
+    RUN_TEST(test_microsteps);
+    return UNITY_END();
+}
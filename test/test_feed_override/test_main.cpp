@@ -0,0 +1,200 @@
+/*
+ * Feed override host test: speed changes of moves in progress, alone and in a SyncDriver
+ *
+ * Copyright (C)2026 Laurentiu Badea
+ *
+ * This file may be redistributed under the terms of the MIT license.
+ * A copy of this license has been included with this distribution in the file LICENSE.
+ */
+#include <Arduino.h>
+#include <unity.h>
+#include "BasicStepperDriver.h"
+#include "SyncDriver.h"
+#include "TMC2100.h"
+
+#define MOTOR_STEPS 200
+#define MICROSTEPS 4
+#define STEP_X 3
+#define STEP_Y 5
+
+BasicStepperDriver x(MOTOR_STEPS, 2, STEP_X);
+BasicStepperDriver y(MOTOR_STEPS, 4, STEP_Y);
+
+/*
+ * Step intervals of each motor, from the rising edges of the step pins
+ */
+unsigned long last_step[2];
+long longest_interval[2];
+long steps_seen[2];
+
+void recordStep(int pin, int value){
+    short i = (pin == STEP_X) ? 0 : (pin == STEP_Y) ? 1 : -1;
+    if (i < 0 || !value){
+        return;
+    }
+    unsigned long now = sim_now;
+    if (steps_seen[i]++){
+        long interval = now - last_step[i];
+        if (interval > longest_interval[i]){
+            longest_interval[i] = interval;
+        }
+    }
+    last_step[i] = now;
+}
+
+void setUp(void){
+    sim_reset();
+    x.begin(120, MICROSTEPS);
+    y.begin(120, MICROSTEPS);
+    x.setPosition(0);
+    y.setPosition(0);
+    memset(longest_interval, 0, sizeof(longest_interval));
+    memset(steps_seen, 0, sizeof(steps_seen));
+    sim_write_hook = recordStep;
+}
+
+void tearDown(void){
+    x.setFeedOverride(1.0);
+    y.setFeedOverride(1.0);
+    sim_write_hook = nullptr;
+}
+
+/*
+ * A slowdown to 0.1x holds the new step pulse until the final brake
+ */
+void test_slowdown(void){
+    x.setSpeedProfile(x.LINEAR_SPEED, 1000, 1000);
+    x.startMove(4000);
+    while (x.getCurrentState() != BasicStepperDriver::CRUISING){
+        x.service(micros());
+    }
+    x.setFeedOverride(0.1);
+    longest_interval[0] = 0;
+    long pulse = STEP_PULSE(MOTOR_STEPS, MICROSTEPS, 12);
+    TEST_ASSERT_FLOAT_WITHIN(0.12, 12, x.getCruiseRPM());
+    while (x.getCurrentState() != BasicStepperDriver::STOPPED &&
+           !(x.getCurrentState() == BasicStepperDriver::DECELERATING && !x.canChangeSpeed())){
+        x.service(micros());
+    }
+    // no step of the slowdown is slower than the new cruise
+    TEST_ASSERT_INT_WITHIN(pulse / 100, pulse, longest_interval[0]);
+    while (x.service(micros()));
+    TEST_ASSERT_EQUAL(4000, x.getPosition());
+}
+
+/*
+ * A speedup to 2x reaches the new speed and ends on the target
+ */
+void test_speedup(void){
+    x.setSpeedProfile(x.LINEAR_SPEED, 1000, 1000);
+    x.startMove(8000);
+    while (x.getCurrentState() != BasicStepperDriver::CRUISING){
+        x.service(micros());
+    }
+    x.setFeedOverride(2.0);
+    TEST_ASSERT_FLOAT_WITHIN(2.4, 240, x.getCruiseRPM());
+    while (x.getCurrentState() != BasicStepperDriver::CRUISING){
+        x.service(micros());
+    }
+    // cruising at the new speed
+    unsigned long start = last_step[0];
+    long steps = steps_seen[0];
+    for (short i = 0; i < 100; i++){
+        x.service(micros());
+        while (x.getTimeToNextAction(micros()));
+    }
+    long pulse = STEP_PULSE(MOTOR_STEPS, MICROSTEPS, 240);
+    TEST_ASSERT_INT_WITHIN(pulse / 100, pulse, (last_step[0] - start) / (steps_seen[0] - steps));
+    while (x.service(micros()));
+    TEST_ASSERT_EQUAL(8000, x.getPosition());
+}
+
+/*
+ * Two motors with different ramps. With <factor>, the override is requested while
+ * accelerating: they change speed together once cruising and stay in proportion.
+ * Returns the time between their last steps.
+ */
+long syncMove(float factor=0){
+    x.setSpeedProfile(x.LINEAR_SPEED, 1000, 2000);
+    y.setSpeedProfile(y.LINEAR_SPEED, 1500, 500);
+    x.setPosition(0);
+    y.setPosition(0);
+    SyncDriver group(x, y);
+    const long X = 6000, Y = 2500;
+    group.startMove(X, Y);
+    group.service(micros());
+    if (factor){
+        group.setFeedOverride(factor);
+        // not applied until both cruise
+        TEST_ASSERT_FLOAT_WITHIN(1.2, 120, x.getCruiseRPM());
+    }
+    float worst = 0;
+    float ratio = 0;
+    while (group.service(micros())){
+        if (factor && !ratio && x.getFeedOverride() == factor){
+            // applied, from here on y moves in proportion to x
+            ratio = (float)y.getStepsRemaining() / x.getStepsRemaining();
+        }
+        if (ratio && x.getStepsRemaining() > 0){
+            // y's distance from its proportional position [steps]
+            float error = fabs(y.getStepsRemaining() - x.getStepsRemaining() * ratio);
+            worst = (error > worst) ? error : worst;
+        }
+    }
+    TEST_ASSERT_EQUAL(X, x.getPosition());
+    TEST_ASSERT_EQUAL(Y, y.getPosition());
+    if (factor){
+        TEST_ASSERT_TRUE(ratio > 0);
+        TEST_ASSERT_LESS_THAN(10, (long)worst);
+    }
+    return labs((long)(last_step[0] - last_step[1]));
+}
+
+/*
+ * The motors arrive as close together as without the override, within a step at
+ * the planned speed (the spread comes from the rounding of the synchronized plan)
+ */
+void syncOverride(float factor){
+    long spread = syncMove();
+    long override_spread = syncMove(factor);
+    TEST_ASSERT_INT_WITHIN(STEP_PULSE(MOTOR_STEPS, MICROSTEPS, 120), spread, override_spread);
+}
+
+void test_sync_slowdown(void){
+    syncOverride(0.4);
+}
+
+void test_sync_speedup(void){
+    syncOverride(2.0);
+}
+
+/*
+ * A TMC2100 cruising on interpolated steps keeps its speed; the next move uses the override
+ */
+void test_interpolated(void){
+    TMC2100 tmc(MOTOR_STEPS, 6, 7, 8, 9);
+    tmc.begin(300, 16);
+    tmc.setInterpolation(100);
+    tmc.setPosition(0);
+    tmc.startMove(4L * MOTOR_STEPS * 16);
+    while (tmc.getCurrentState() != BasicStepperDriver::CRUISING || tmc.canChangeSpeed()){
+        tmc.service(micros());
+    }
+    tmc.setFeedOverride(0.5);
+    TEST_ASSERT_FLOAT_WITHIN(3, 300, tmc.getCruiseRPM());
+    while (tmc.service(micros()));
+    TEST_ASSERT_EQUAL(4L * MOTOR_STEPS * 16, tmc.getPosition());
+    tmc.startMove(MOTOR_STEPS * 16);
+    TEST_ASSERT_FLOAT_WITHIN(1.5, 150, tmc.getCruiseRPM());
+    while (tmc.service(micros()));
+}
+
+int main(void){
+    UNITY_BEGIN();
+    RUN_TEST(test_slowdown);
+    RUN_TEST(test_speedup);
+    RUN_TEST(test_sync_slowdown);
+    RUN_TEST(test_sync_speedup);
+    RUN_TEST(test_interpolated);
+    return UNITY_END();
+}
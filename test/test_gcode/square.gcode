@@ -0,0 +1,13 @@
+; 10x10 square at F600 with a dwell at two corners, then a relative rapid move
+G90 (absolute)
+G1 X10 F600
+G4 P100
+Y10
+G4 S0.1
+X0
+Y0
+G91 ; relative from here
+G0 X-5 Y5
+G92 X0 Y0
+Z7 (no Z motor in a 2-motor group)
+X2.5
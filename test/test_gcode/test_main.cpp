@@ -0,0 +1,161 @@
+/*
+ * GCodeInterpreter host test: runs G-code files and lines on a simulated 2-motor group
+ *
+ * Copyright (C)2026 Laurentiu Badea
+ *
+ * This file may be redistributed under the terms of the MIT license.
+ * A copy of this license has been included with this distribution in the file LICENSE.
+ */
+#include <Arduino.h>
+#include <unity.h>
+#include <string>
+#include "BasicStepperDriver.h"
+#include "MultiDriver.h"
+#include "GCodeInterpreter.h"
+
+#define MOTOR_STEPS 200
+#define STEPS_PER_UNIT 10
+
+BasicStepperDriver m1(MOTOR_STEPS, 2, 3);
+BasicStepperDriver m2(MOTOR_STEPS, 4, 5);
+
+/*
+ * Stream reading a file next to this test
+ */
+class FileStream : public Stream {
+protected:
+    FILE* file;
+public:
+    FileStream(const char* name){
+        std::string path = __FILE__;
+        path = path.substr(0, path.find_last_of('/') + 1) + name;
+        file = fopen(path.c_str(), "r");
+    }
+    ~FileStream(){
+        if (file){
+            fclose(file);
+        }
+    }
+    bool isOpen(void){
+        return file != nullptr;
+    }
+    int available(void) override {
+        return peek() != EOF;
+    }
+    int read(void) override {
+        return getc(file);
+    }
+    int peek(void) override {
+        int c = getc(file);
+        if (c != EOF){
+            ungetc(c, file);
+        }
+        return c;
+    }
+    size_t write(uint8_t) override {
+        return 0;
+    }
+};
+
+void setUp(void){
+    sim_reset();
+    m1.setPosition(0);
+    m2.setPosition(0);
+}
+
+void tearDown(void){}
+
+void feedLine(GCodeInterpreter& gcode, const char* line){
+    while (*line){
+        TEST_ASSERT_TRUE(gcode.feed(*line++));
+    }
+}
+
+// run the queued moves to completion, returns the time it took (micros)
+unsigned long runQueue(GCodeInterpreter& gcode){
+    unsigned long start = micros();
+    while (gcode.service(micros()));
+    return micros() - start;
+}
+
+/*
+ * Stream a G-code file while the moves execute
+ */
+void test_file(void){
+    MultiDriver group(m1, m2);
+    group.begin(60, 1);
+    GCodeInterpreter gcode(group);
+    gcode.setStepsPerUnit(STEPS_PER_UNIT, STEPS_PER_UNIT);
+    FileStream input("square.gcode");
+    TEST_ASSERT_TRUE(input.isOpen());
+
+    unsigned long start = micros();
+    bool busy = true;
+    while (busy || input.available()){
+        gcode.process(input);
+        busy = gcode.service(micros());
+    }
+    unsigned long elapsed = micros() - start;
+
+    // X: +10 -10 -5 +2.5, Y: +10 -10 +5 (units)
+    TEST_ASSERT_EQUAL(-25, m1.getPosition());
+    TEST_ASSERT_EQUAL(50, m2.getPosition());
+    TEST_ASSERT_EQUAL(275, sim_edges[3]);
+    TEST_ASSERT_EQUAL(250, sim_edges[5]);
+    TEST_ASSERT_FLOAT_WITHIN(0.001, 2.5, gcode.getPosition(0));
+    TEST_ASSERT_FLOAT_WITHIN(0.001, 0, gcode.getPosition(1));
+    TEST_ASSERT_FLOAT_WITHIN(0.001, 0, gcode.getPosition(2));
+    // four sides at 10 units/s and two 100ms dwells, plus the rapid moves at 60rpm
+    TEST_ASSERT_GREATER_THAN(4200000UL, elapsed);
+}
+
+/*
+ * Z words on a 2-motor group neither queue a move nor change the position
+ */
+void test_missing_axis(void){
+    MultiDriver group(m1, m2);
+    group.begin(60, 1);
+    GCodeInterpreter gcode(group);
+    gcode.setStepsPerUnit(STEPS_PER_UNIT, STEPS_PER_UNIT, STEPS_PER_UNIT);
+
+    feedLine(gcode, "G1 Z5 F600\n");
+    feedLine(gcode, "G92 Z3\n");
+    TEST_ASSERT_EQUAL(GCODE_QUEUE_SIZE, gcode.available());
+    TEST_ASSERT_FLOAT_WITHIN(0.001, 0, gcode.getPosition(2));
+
+    feedLine(gcode, "G1 X1 Z5\n");
+    TEST_ASSERT_EQUAL(GCODE_QUEUE_SIZE - 1, gcode.available());
+    runQueue(gcode);
+    TEST_ASSERT_EQUAL(10, m1.getPosition());
+    TEST_ASSERT_EQUAL(0, m2.getPosition());
+    TEST_ASSERT_FLOAT_WITHIN(0.001, 1, gcode.getPosition(0));
+    TEST_ASSERT_FLOAT_WITHIN(0.001, 0, gcode.getPosition(2));
+}
+
+/*
+ * G4 waits for its P (ms) or S (s) time without moving
+ */
+void test_dwell(void){
+    MultiDriver group(m1, m2);
+    group.begin(60, 1);
+    GCodeInterpreter gcode(group);
+
+    feedLine(gcode, "G4 P250\n");
+    unsigned long elapsed = runQueue(gcode);
+    TEST_ASSERT_INT_WITHIN(1000, 250000, elapsed);
+
+    feedLine(gcode, "G4 S0.5\n");
+    elapsed = runQueue(gcode);
+    TEST_ASSERT_INT_WITHIN(1000, 500000, elapsed);
+
+    TEST_ASSERT_EQUAL(0, sim_edges[3]);
+    TEST_ASSERT_EQUAL(0, sim_edges[5]);
+}
+
+int main(void){
+    UNITY_BEGIN();
+    RUN_TEST(test_file);
+    RUN_TEST(test_missing_axis);
+    RUN_TEST(test_dwell);
+    return UNITY_END();
+}
@@ -0,0 +1,164 @@
+/*
+ * Electronic gearing host test: slave steps following the master through moves
+ *
+ * Copyright (C)2026 Laurentiu Badea
+ *
+ * This file may be redistributed under the terms of the MIT license.
+ * A copy of this license has been included with this distribution in the file LICENSE.
+ */
+#include <Arduino.h>
+#include <unity.h>
+#include "BasicStepperDriver.h"
+#include "MultiDriver.h"
+
+#define MOTOR_STEPS 200
+#define SLAVE_STEP 5
+#define SLAVE_ENABLE 9
+
+BasicStepperDriver master(MOTOR_STEPS, 2, 3);
+BasicStepperDriver slave(MOTOR_STEPS, 4, SLAVE_STEP, SLAVE_ENABLE);
+
+void setUp(void){
+    sim_reset();
+    master.begin(120, 1);
+    slave.begin(120, 1);
+    master.setPosition(0);
+    slave.setPosition(0);
+}
+
+void tearDown(void){
+    slave.setAutoPower(0);
+}
+
+void run(MultiDriver& group, long steps){
+    group.startMove(steps, 0);
+    while (group.service(micros()));
+}
+
+void test_ratio(void){
+    MultiDriver group(master, slave);
+    TEST_ASSERT_TRUE(group.setGear(0, 1, -1, 3));
+    run(group, 300);
+    TEST_ASSERT_EQUAL(300, master.getPosition());
+    TEST_ASSERT_EQUAL(-100, slave.getPosition());
+    TEST_ASSERT_EQUAL(100, sim_edges[SLAVE_STEP]);
+}
+
+void test_invalid_ratio(void){
+    MultiDriver group(master, slave);
+    TEST_ASSERT_FALSE(group.setGear(0, 1, 1, 0));
+    TEST_ASSERT_FALSE(group.setGear(0, 1, 1, -2));
+    // not geared, the slave keeps its own (empty) move
+    run(group, 20);
+    TEST_ASSERT_EQUAL(0, slave.getPosition());
+
+    TEST_ASSERT_TRUE(group.setGear(0, 1, 1, 2));
+    TEST_ASSERT_FALSE(group.setGear(0, 1, 1, 0));
+    run(group, 20);
+    TEST_ASSERT_EQUAL(10, slave.getPosition());
+}
+
+/*
+ * Back-to-back 1-step moves: each new move restarts the master's step count at 1
+ */
+void test_short_moves(void){
+    MultiDriver group(master, slave);
+    group.setGear(0, 1, 1, 1);
+    for (short i = 0; i < 5; i++){
+        run(group, 1);
+    }
+    run(group, -2);
+    TEST_ASSERT_EQUAL(3, master.getPosition());
+    TEST_ASSERT_EQUAL(3, slave.getPosition());
+    TEST_ASSERT_EQUAL(7, sim_edges[SLAVE_STEP]);
+}
+
+/*
+ * A slave turned off by auto power is woken up for the next move
+ */
+void test_auto_power(void){
+    MultiDriver group(master, slave);
+    group.setGear(0, 1, 1, 1);
+    slave.setAutoPower(50);
+    run(group, 10);
+    unsigned long start = millis();
+    while (millis() - start < 60){
+        group.service(micros());
+        delayMicroseconds(500);
+    }
+    TEST_ASSERT_FALSE(slave.isEnabled());
+
+    group.startMove(10, 0);
+    TEST_ASSERT_TRUE(slave.isEnabled());
+    TEST_ASSERT_EQUAL(HIGH, sim_pin[SLAVE_ENABLE]);
+    while (group.service(micros()));
+    TEST_ASSERT_EQUAL(20, slave.getPosition());
+
+    // the slave is also woken by a step if it was turned off during the move
+    slave.disable();
+    slave.step(1);
+    TEST_ASSERT_TRUE(slave.isEnabled());
+    TEST_ASSERT_EQUAL(21, slave.getPosition());
+}
+
+/*
+ * Master and slave must be two different motors of the group
+ */
+void test_invalid_motors(void){
+    MultiDriver group(master, slave);
+    TEST_ASSERT_FALSE(group.setGear(0, 0, 1, 1));
+    TEST_ASSERT_FALSE(group.setGear(0, 2, 1, 1));
+    TEST_ASSERT_FALSE(group.setGear(-1, 1, 1, 1));
+    TEST_ASSERT_FALSE(group.setGear(1, 5, 1, 1));
+    run(group, 20);
+    TEST_ASSERT_EQUAL(0, slave.getPosition());
+}
+
+/*
+ * The slave's pulses are scheduled, not waited for: service() returns right away
+ * even with a long STEP low time on the slave
+ */
+void test_service_never_waits(void){
+    MultiDriver group(master, slave);
+    group.setGear(0, 1, 1, 1);
+    slave.setMinStepPulse(1, 200);
+    group.startMove(100, 0);
+    unsigned long longest = 0;
+    bool running = true;
+    while (running){
+        unsigned long start = micros();
+        running = group.service(start);
+        if (micros() - start > longest){
+            longest = micros() - start;
+        }
+    }
+    slave.setMinStepPulse(1, 1);
+    TEST_ASSERT_EQUAL(100, master.getPosition());
+    TEST_ASSERT_EQUAL(100, slave.getPosition());
+    TEST_ASSERT_EQUAL(100, sim_edges[SLAVE_STEP]);
+    TEST_ASSERT_LESS_THAN(20, (long)longest);
+}
+
+/*
+ * The blocking nextAction() loop fires the slave steps too
+ */
+void test_blocking_move(void){
+    MultiDriver group(master, slave);
+    group.setGear(0, 1, 2, 1);
+    group.move(-50, 0);
+    TEST_ASSERT_EQUAL(-50, master.getPosition());
+    TEST_ASSERT_EQUAL(-100, slave.getPosition());
+    TEST_ASSERT_EQUAL(100, sim_edges[SLAVE_STEP]);
+}
+
+int main(void){
+    UNITY_BEGIN();
+    RUN_TEST(test_ratio);
+    RUN_TEST(test_invalid_ratio);
+    RUN_TEST(test_short_moves);
+    RUN_TEST(test_auto_power);
+    RUN_TEST(test_invalid_motors);
+    RUN_TEST(test_service_never_waits);
+    RUN_TEST(test_blocking_move);
+    return UNITY_END();
+}
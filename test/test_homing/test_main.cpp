@@ -0,0 +1,141 @@
+/*
+ * Homing host test: a simulated limit switch follows the motor's step and
+ * direction pins and drives the switch input (and its interrupt).
+ *
+ * Copyright (C)2026 Laurentiu Badea
+ *
+ * This file may be redistributed under the terms of the MIT license.
+ * A copy of this license has been included with this distribution in the file LICENSE.
+ */
+#include <Arduino.h>
+#include <unity.h>
+#include "BasicStepperDriver.h"
+#include "Homing.h"
+
+#define MOTOR_STEPS 200
+#define DIR 8
+#define STEP 9
+#define SWITCH 2
+// switch closes at this position and opens again HYSTERESIS steps away from it
+#define SWITCH_AT -1000
+#define HYSTERESIS 5
+#define BACKOFF 100
+
+BasicStepperDriver motor(MOTOR_STEPS, DIR, STEP);
+
+long position;          // actual motor position, from the pins
+bool pressed;
+bool broken;            // switch closes only once
+bool closed;
+
+void switchHook(int pin, int value){
+    if (pin != STEP || !value){
+        return;
+    }
+    position += (sim_pin[DIR] == HIGH) ? 1 : -1;
+    if (!pressed && position <= SWITCH_AT && !(broken && closed)){
+        pressed = true;
+        closed = true;
+    } else if (pressed && position > SWITCH_AT + HYSTERESIS){
+        pressed = false;
+    }
+    sim_input(SWITCH, pressed ? LOW : HIGH);
+}
+
+void setUp(void){
+    sim_reset();
+    position = 0;
+    pressed = false;
+    broken = false;
+    closed = false;
+    sim_input(SWITCH, HIGH);
+    sim_write_hook = switchHook;
+    motor.begin(120, 1);
+    motor.setPosition(0);
+}
+
+void tearDown(void){}
+
+Homing* newHoming(void){
+    Homing* homing = new Homing(motor, SWITCH);
+    homing->setSpeeds(600, 60);
+    homing->setDistances(BACKOFF, 5000);
+    return homing;
+}
+
+void test_home(void){
+    Homing* homing = newHoming();
+    TEST_ASSERT_TRUE(homing->home());
+    TEST_ASSERT_EQUAL(0, motor.getPosition());
+    TEST_ASSERT_EQUAL(SWITCH_AT, position);
+    TEST_ASSERT_TRUE(sim_isr[SWITCH] == nullptr);
+    delete homing;
+}
+
+void test_home_from_switch(void){
+    position = SWITCH_AT - 2;
+    pressed = true;
+    sim_input(SWITCH, LOW);
+    Homing* homing = newHoming();
+    TEST_ASSERT_TRUE(homing->home());
+    TEST_ASSERT_EQUAL(SWITCH_AT, position);
+    delete homing;
+}
+
+/*
+ * LOCATE gives up where the seek stopped, not after twice the backoff
+ */
+void test_locate_travel(void){
+    broken = true;
+    Homing* homing = newHoming();
+    TEST_ASSERT_FALSE(homing->home());
+    TEST_ASSERT_EQUAL(Homing::FAILED, homing->getStage());
+    TEST_ASSERT_GREATER_OR_EQUAL(SWITCH_AT - 1, position);
+    delete homing;
+}
+
+/*
+ * Cancelled, restarted and destroyed runs give their interrupt slot back
+ */
+void test_slots(void){
+    const short pins[HOMING_MAX_AXES] = {20, 21, 22};
+    BasicStepperDriver others[HOMING_MAX_AXES] = {
+        BasicStepperDriver(MOTOR_STEPS, 30, 31),
+        BasicStepperDriver(MOTOR_STEPS, 32, 33),
+        BasicStepperDriver(MOTOR_STEPS, 34, 35)
+    };
+    Homing* homing = newHoming();
+    homing->start();
+    homing->start();
+    homing->service(micros());
+    homing->cancel();
+    TEST_ASSERT_EQUAL(Homing::IDLE, homing->getStage());
+    TEST_ASSERT_TRUE(sim_isr[SWITCH] == nullptr);
+
+    // abandoned without cancel()
+    homing->start();
+    delete homing;
+    TEST_ASSERT_TRUE(sim_isr[SWITCH] == nullptr);
+
+    Homing* axes[HOMING_MAX_AXES];
+    for (short i = 0; i < HOMING_MAX_AXES; i++){
+        sim_input(pins[i], HIGH);
+        others[i].begin(120, 1);
+        axes[i] = new Homing(others[i], pins[i]);
+        axes[i]->start();
+    }
+    for (short i = 0; i < HOMING_MAX_AXES; i++){
+        TEST_ASSERT_TRUE(sim_isr[pins[i]] != nullptr);
+        axes[i]->cancel();
+        delete axes[i];
+    }
+}
+
+int main(void){
+    UNITY_BEGIN();
+    RUN_TEST(test_home);
+    RUN_TEST(test_home_from_switch);
+    RUN_TEST(test_locate_travel);
+    RUN_TEST(test_slots);
+    return UNITY_END();
+}
@@ -0,0 +1,159 @@
+/*
+ * Moves and positions past 2^31 microsteps, through the group, task, encoder and
+ * G-code interfaces. Built with STEPPER_LONG_MOVES (env native_long), where steps_t is
+ * long long and so differs from long even on 64-bit hosts: the interface checks below
+ * catch any long left in a steps_t path.
+ *
+ * Copyright (C)2026 Laurentiu Badea
+ *
+ * This file may be redistributed under the terms of the MIT license.
+ * A copy of this license has been included with this distribution in the file LICENSE.
+ */
+#include <Arduino.h>
+#include <unity.h>
+#include <type_traits>
+#include "BasicStepperDriver.h"
+#include "MultiDriver.h"
+#include "SyncDriver.h"
+#include "StepperTask.h"
+#include "ClosedLoop.h"
+#include "GCodeInterpreter.h"
+
+#define MOTOR_STEPS 200
+// past 2^31
+#define FAR 3000000000LL
+
+#define ASSERT_TYPE(type, expr) static_assert(std::is_same<type, decltype(expr)>::value, #expr " is not " #type)
+ASSERT_TYPE(void (MultiDriver::*)(steps_t, steps_t, steps_t), &MultiDriver::startMove);
+ASSERT_TYPE(void (MultiDriver::*)(steps_t, steps_t, steps_t), &MultiDriver::move);
+ASSERT_TYPE(void (SyncDriver::*)(steps_t, steps_t, steps_t), &SyncDriver::startMove);
+ASSERT_TYPE(bool (StepperTask::*)(steps_t, steps_t, steps_t), &StepperTask::startMove);
+ASSERT_TYPE(void (ClosedLoop::*)(steps_t), &ClosedLoop::startMove);
+ASSERT_TYPE(steps_t (ClosedLoop::*)(void), &ClosedLoop::getActualPosition);
+ASSERT_TYPE(steps_t[3], MultiDriver::Steps::steps);
+ASSERT_TYPE(steps_t[3], GCodeInterpreter::Command::steps);
+ASSERT_TYPE(steps_t[3], StepperTask::Command::steps);
+
+BasicStepperDriver m1(MOTOR_STEPS, 2, 3);
+BasicStepperDriver m2(MOTOR_STEPS, 4, 5);
+
+void setUp(void){
+    sim_reset();
+    m1.begin(120, 1);
+    m2.begin(120, 1);
+    m1.setPosition(0);
+    m2.setPosition(0);
+}
+
+void tearDown(void){}
+
+void runSteps(MultiDriver& group, BasicStepperDriver& motor, steps_t steps){
+    while (motor.getStepsCompleted() < steps && group.service(micros()));
+}
+
+void test_multi(void){
+    MultiDriver group(m1, m2);
+    group.startMove(FAR, -FAR);
+    runSteps(group, m1, 100);
+    MultiDriver::Steps remaining = group.stop();
+    TEST_ASSERT_GREATER_THAN(FAR - 110, remaining.steps[0]);
+    TEST_ASSERT_GREATER_THAN(FAR - 110, remaining.steps[1]);
+    TEST_ASSERT_EQUAL(-m1.getPosition(), m2.getPosition());
+}
+
+void test_sync(void){
+    SyncDriver group(m1, m2);
+    group.startMove(FAR, FAR / 2);
+    TEST_ASSERT_EQUAL(FAR, m1.getStepsRemaining());
+    TEST_ASSERT_EQUAL(FAR / 2, m2.getStepsRemaining());
+    runSteps(group, m1, 100);
+    MultiDriver::Steps remaining = group.stop();
+    TEST_ASSERT_GREATER_THAN(FAR - 110, remaining.steps[0]);
+    TEST_ASSERT_GREATER_THAN(FAR / 2 - 110, remaining.steps[1]);
+}
+
+/*
+ * Time of the last step of each motor
+ */
+unsigned long last_step[2];
+
+void recordStep(int pin, int value){
+    if (value && (pin == 3 || pin == 5)){
+        last_step[pin == 5] = sim_now;
+    }
+}
+
+/*
+ * A synchronized move taking more than 2^31us: few steps at a very low speed,
+ * skipping the simulated clock ahead to each step. Both motors finish together
+ * (SyncDriver used to plan it with the time saturated at 2^31-1us).
+ */
+void test_sync_time(void){
+    const float RPM = 0.01;
+    const long PULSE = STEP_PULSE(MOTOR_STEPS, 1, RPM);
+    m1.setRPM(RPM);
+    m2.setRPM(RPM);
+    TEST_ASSERT_TRUE(m1.getTimeForMove(100) > 0x7FFFFFFFLL);
+    sim_write_hook = recordStep;
+    SyncDriver group(m1, m2);
+    group.startMove(100, 40);
+    while (group.service(micros())){
+        sim_now += group.getTimeToNextAction(micros());
+    }
+    sim_write_hook = nullptr;
+    TEST_ASSERT_EQUAL(100, m1.getPosition());
+    TEST_ASSERT_EQUAL(40, m2.getPosition());
+    TEST_ASSERT_TRUE(last_step[0] > 0x7FFFFFFFUL);
+    // each move ends one of its own (stretched) step pulses after its last step
+    TEST_ASSERT_INT_WITHIN(PULSE / 100, last_step[0] + PULSE, last_step[1] + 100 * PULSE / 40);
+}
+
+void test_positions(void){
+    MultiDriver group(m1, m2);
+    m1.setPosition(FAR);
+    m2.setPosition(-FAR);
+    group.move(100, -100);
+    TEST_ASSERT_EQUAL(FAR + 100, m1.getPosition());
+    TEST_ASSERT_EQUAL(-FAR - 100, m2.getPosition());
+}
+
+void test_closed_loop(void){
+    QuadratureEncoder encoder(20, 21);
+    ClosedLoop loop(m1, encoder, 4 * MOTOR_STEPS);
+    m1.setPosition(FAR);
+    loop.begin();
+    TEST_ASSERT_EQUAL(FAR, loop.getActualPosition());
+    // no encoder signal: the motor stalls after a few steps, at the far position
+    loop.setLimits(1, 4, 1);
+    loop.move(-100);
+    TEST_ASSERT_TRUE(loop.isStalled());
+    TEST_ASSERT_EQUAL(FAR, m1.getPosition());
+}
+
+void test_gcode(void){
+    MultiDriver group(m1, m2);
+    GCodeInterpreter gcode(group);
+    gcode.setStepsPerUnit(1000000, 1);
+    const char* program = "G0 X3000\n";
+    for (const char* c = program; *c; c++){
+        TEST_ASSERT_TRUE(gcode.feed(*c));
+    }
+    TEST_ASSERT_FLOAT_WITHIN(0.001, 3000, gcode.getPosition(0));
+    gcode.service(micros());
+    TEST_ASSERT_EQUAL(FAR, m1.getStepsRemaining());
+    group.stop();
+}
+
+int main(void){
+    UNITY_BEGIN();
+    RUN_TEST(test_multi);
+    RUN_TEST(test_sync);
+#ifdef STEPPER_LONG_MOVES
+    // 32-bit move times saturate
+    RUN_TEST(test_sync_time);
+#endif
+    RUN_TEST(test_positions);
+    RUN_TEST(test_closed_loop);
+    RUN_TEST(test_gcode);
+    return UNITY_END();
+}
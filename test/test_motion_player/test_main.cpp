@@ -0,0 +1,179 @@
+/*
+ * MotionPlayer host test: record framing, resync after lost or corrupted bytes,
+ * dwell validation, and a job generated by extras/steps2motion.py
+ *
+ * Copyright (C)2026 Laurentiu Badea
+ *
+ * This file may be redistributed under the terms of the MIT license.
+ * A copy of this license has been included with this distribution in the file LICENSE.
+ */
+#include <Arduino.h>
+#include <unity.h>
+#include <string>
+#include <vector>
+#include "BasicStepperDriver.h"
+#include "MultiDriver.h"
+#include "MotionPlayer.h"
+
+#define MOTOR_STEPS 200
+
+BasicStepperDriver m1(MOTOR_STEPS, 2, 3);
+BasicStepperDriver m2(MOTOR_STEPS, 4, 5);
+BasicStepperDriver m3(MOTOR_STEPS, 6, 7);
+
+void setUp(void){
+    sim_reset();
+    m1.setPosition(0);
+    m2.setPosition(0);
+    m3.setPosition(0);
+}
+
+void tearDown(void){}
+
+void append(std::vector<uint8_t>& stream, int16_t s1, int16_t s2, int16_t s3, uint8_t flags=0){
+    MotionPlayer::Segment segment = {{s1, s2, s3}, 0, flags};
+    uint8_t record[MOTION_SEGMENT_SIZE];
+    MotionPlayer::encode(segment, record);
+    stream.insert(stream.end(), record, record + MOTION_SEGMENT_SIZE);
+}
+
+// feed the bytes while playing the segments, until the job ends or the input runs out
+unsigned long play(MotionPlayer& player, const std::vector<uint8_t>& stream){
+    unsigned long start = micros();
+    size_t next = 0;
+    bool busy = true;
+    while (busy || next < stream.size()){
+        while (next < stream.size() && player.feed(stream[next])){
+            next++;
+        }
+        busy = player.service(micros());
+    }
+    return micros() - start;
+}
+
+void test_records(void){
+    MultiDriver group(m1, m2, m3);
+    group.begin(600, 1);
+    MotionPlayer player(group);
+    std::vector<uint8_t> stream;
+    // payload bytes equal to MOTION_SYNC must not confuse the framing
+    append(stream, 0xA5, -0xA5, 0x1A5);
+    append(stream, -100, 200, 0);
+    append(stream, 0, 0, 0, MOTION_END);
+    play(player, stream);
+
+    TEST_ASSERT_TRUE(player.isEnded());
+    TEST_ASSERT_EQUAL(0, player.getErrors());
+    TEST_ASSERT_EQUAL(0xA5 - 100, m1.getPosition());
+    TEST_ASSERT_EQUAL(-0xA5 + 200, m2.getPosition());
+    TEST_ASSERT_EQUAL(0x1A5, m3.getPosition());
+}
+
+/*
+ * A lost byte, a corrupted byte and line noise each cost only the affected record
+ */
+void test_resync(void){
+    MultiDriver group(m1, m2, m3);
+    group.begin(600, 1);
+    MotionPlayer player(group);
+    std::vector<uint8_t> stream;
+    append(stream, 1, 0, 0);
+    append(stream, 2, 0, 0);
+    stream.erase(stream.end() - 4);             // lost byte
+    append(stream, 4, 0, 0);
+    append(stream, 8, 0, 0);
+    stream[stream.size() - 6] ^= 0x10;          // corrupted byte
+    const uint8_t noise[] = {0xA5, 0x00, 0xA5, 0xA5, 0x13};
+    stream.insert(stream.end(), noise, noise + sizeof(noise));
+    append(stream, 16, 0, 0);
+    append(stream, 32, 0, 0, MOTION_END);
+    play(player, stream);
+
+    TEST_ASSERT_TRUE(player.isEnded());
+    TEST_ASSERT_EQUAL(1 + 4 + 16 + 32, m1.getPosition());
+    TEST_ASSERT_GREATER_OR_EQUAL(2, player.getErrors());
+}
+
+/*
+ * Dwell records wait their time; a negative time is rejected instead of becoming
+ * a wait of days
+ */
+void test_dwell(void){
+    MultiDriver group(m1, m2, m3);
+    group.begin(600, 1);
+    MotionPlayer player(group);
+    std::vector<uint8_t> stream;
+    append(stream, -5, 0, 0, MOTION_DWELL);
+    append(stream, 250, 0, 0, MOTION_DWELL | MOTION_END);
+    unsigned long elapsed = play(player, stream);
+
+    TEST_ASSERT_TRUE(player.isEnded());
+    TEST_ASSERT_EQUAL(1, player.getErrors());
+    TEST_ASSERT_INT_WITHIN(1000, 250000, elapsed);
+    TEST_ASSERT_EQUAL(0, sim_edges[3]);
+}
+
+/*
+ * Play job.bin, made from job.csv by extras/steps2motion.py, through a Stream
+ */
+class FileStream : public Stream {
+protected:
+    FILE* file;
+public:
+    FileStream(const char* name){
+        std::string path = __FILE__;
+        path = path.substr(0, path.find_last_of('/') + 1) + name;
+        file = fopen(path.c_str(), "rb");
+    }
+    ~FileStream(){
+        if (file){
+            fclose(file);
+        }
+    }
+    bool isOpen(void){
+        return file != nullptr;
+    }
+    int available(void) override {
+        return peek() != EOF;
+    }
+    int read(void) override {
+        return getc(file);
+    }
+    int peek(void) override {
+        int c = getc(file);
+        if (c != EOF){
+            ungetc(c, file);
+        }
+        return c;
+    }
+    size_t write(uint8_t) override {
+        return 0;
+    }
+};
+
+void test_job_file(void){
+    MultiDriver group(m1, m2, m3);
+    group.begin(6000, 1);
+    MotionPlayer player(group);
+    FileStream input("job.bin");
+    TEST_ASSERT_TRUE(input.isOpen());
+    bool busy = true;
+    while (busy || input.available()){
+        player.process(input);
+        busy = player.service(micros());
+    }
+    TEST_ASSERT_TRUE(player.isEnded());
+    TEST_ASSERT_EQUAL(0, player.getErrors());
+    TEST_ASSERT_EQUAL(100 - 40000, m1.getPosition());
+    TEST_ASSERT_EQUAL(50 + 20000, m2.getPosition());
+    TEST_ASSERT_EQUAL(60, m3.getPosition());
+}
+
+int main(void){
+    UNITY_BEGIN();
+    RUN_TEST(test_records);
+    RUN_TEST(test_resync);
+    RUN_TEST(test_dwell);
+    RUN_TEST(test_job_file);
+    return UNITY_END();
+}
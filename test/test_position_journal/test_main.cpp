@@ -0,0 +1,199 @@
+/*
+ * Position journal host test: the journal is kept in a file that behaves like AVR
+ * EEPROM (blank 0xFF, a byte write takes 3.3ms and the next one waits for it), and
+ * resets are simulated by starting a new journal on the same file.
+ *
+ * Copyright (C)2026 Laurentiu Badea
+ *
+ * This file may be redistributed under the terms of the MIT license.
+ * A copy of this license has been included with this distribution in the file LICENSE.
+ */
+#include <Arduino.h>
+#include <unity.h>
+#include "BasicStepperDriver.h"
+#include "PositionJournal.h"
+
+#define MOTOR_STEPS 200
+#define STEP 3
+#define EEPROM_SIZE 200
+// AVR EEPROM byte write time (us)
+#define WRITE_TIME 3300
+
+class FileStorage final : public JournalStorage {
+protected:
+    FILE* file;
+    unsigned long last_write = 0;
+    bool busy = false;
+
+public:
+    long writes = 0;
+    // power loss after this many more byte writes (-1: never)
+    long writes_left = -1;
+
+    FileStorage(void){
+        file = tmpfile();
+        erase();
+    }
+    ~FileStorage(){
+        fclose(file);
+    }
+    void erase(void){
+        fseek(file, 0, SEEK_SET);
+        for (unsigned i = 0; i < EEPROM_SIZE; i++){
+            fputc(0xFF, file);
+        }
+        fflush(file);
+    }
+    unsigned size(void) override {
+        return EEPROM_SIZE;
+    }
+    uint8_t read(unsigned address) override {
+        fseek(file, address, SEEK_SET);
+        return fgetc(file);
+    }
+    void write(unsigned address, uint8_t value) override {
+        if (read(address) == value || !writes_left){
+            return;
+        }
+        // like eeprom_write_byte(), wait for the previous write
+        while (!isReady()){
+            delayMicroseconds(10);
+        }
+        fseek(file, address, SEEK_SET);
+        fputc(value, file);
+        fflush(file);
+        writes++;
+        writes_left--;
+        busy = true;
+        last_write = micros();
+    }
+    bool isReady(void) override {
+        if (busy && micros() - last_write >= WRITE_TIME){
+            busy = false;
+        }
+        return !busy;
+    }
+};
+
+BasicStepperDriver motor(MOTOR_STEPS, 2, STEP);
+FileStorage* storage;
+
+void setUp(void){
+    sim_reset();
+    storage = new FileStorage();
+    motor.begin(120, 1);
+    motor.setPosition(0);
+}
+
+void tearDown(void){
+    delete storage;
+}
+
+/*
+ * Reset: the motor forgets its position, a new journal restores it
+ */
+bool reset(PositionJournal*& journal){
+    delete journal;
+    motor.setPosition(12345);
+    journal = new PositionJournal(motor, *storage);
+    return journal->begin();
+}
+
+void test_restore(void){
+    PositionJournal* journal = new PositionJournal(motor, *storage);
+    TEST_ASSERT_FALSE(journal->begin());
+    TEST_ASSERT_FALSE(journal->isExact());
+    journal->move(300);
+    journal->move(-100);
+    TEST_ASSERT_TRUE(reset(journal));
+    TEST_ASSERT_TRUE(journal->isExact());
+    TEST_ASSERT_EQUAL(200, motor.getPosition());
+    // the records went round the ring and the newest one is still found
+    for (short i = 0; i < 30; i++){
+        journal->move(1);
+    }
+    TEST_ASSERT_TRUE(reset(journal));
+    TEST_ASSERT_EQUAL(230, motor.getPosition());
+    delete journal;
+}
+
+/*
+ * Power lost while moving: the position journaled during the move is restored, not
+ * exact, with the target of the move
+ */
+void test_power_loss_moving(void){
+    PositionJournal* journal = new PositionJournal(motor, *storage);
+    journal->begin();
+    journal->setInterval(100);
+    journal->startMove(1000);
+    // 400 steps/s: 150ms covers an interval record
+    unsigned long start = micros();
+    while (micros() - start < 150000){
+        journal->service(micros());
+    }
+    steps_t position = motor.getPosition();
+    TEST_ASSERT_TRUE(reset(journal));
+    TEST_ASSERT_FALSE(journal->isExact());
+    TEST_ASSERT_GREATER_THAN(0, motor.getPosition());
+    TEST_ASSERT_LESS_OR_EQUAL(position, motor.getPosition());
+    TEST_ASSERT_EQUAL(1000, journal->getTarget());
+    delete journal;
+}
+
+/*
+ * A record torn by a power loss is ignored, the one before it is used
+ */
+void test_torn_record(void){
+    PositionJournal* journal = new PositionJournal(motor, *storage);
+    journal->begin();
+    journal->move(50);
+    motor.setPosition(-777);
+    storage->writes_left = 4;
+    journal->save();
+    TEST_ASSERT_TRUE(reset(journal));
+    TEST_ASSERT_TRUE(journal->isExact());
+    TEST_ASSERT_EQUAL(50, motor.getPosition());
+    delete journal;
+}
+
+/*
+ * Interval records during a move are written a byte at a time between steps,
+ * without waiting for the EEPROM, so the steps stay on time
+ */
+void test_step_timing(void){
+    PositionJournal* journal = new PositionJournal(motor, *storage);
+    journal->begin();
+    motor.setRPM(600);  // 2000 steps/s, 500us
+    journal->setInterval(20);
+    journal->startMove(2000);
+    long writes = storage->writes;
+    unsigned long last_step = 0;
+    unsigned long max_gap = 0;
+    long edges = sim_edges[STEP];
+    while (journal->service(micros())){
+        if (sim_edges[STEP] != edges){
+            edges = sim_edges[STEP];
+            unsigned long now = micros();
+            if (last_step && now - last_step > max_gap){
+                max_gap = now - last_step;
+            }
+            last_step = now;
+        }
+    }
+    // a 1s move with a record every 20ms
+    TEST_ASSERT_GREATER_THAN(writes + 40, storage->writes);
+    TEST_ASSERT_LESS_OR_EQUAL(520, max_gap);
+    TEST_ASSERT_TRUE(reset(journal));
+    TEST_ASSERT_TRUE(journal->isExact());
+    TEST_ASSERT_EQUAL(2000, motor.getPosition());
+    delete journal;
+}
+
+int main(void){
+    UNITY_BEGIN();
+    RUN_TEST(test_restore);
+    RUN_TEST(test_power_loss_moving);
+    RUN_TEST(test_torn_record);
+    RUN_TEST(test_step_timing);
+    return UNITY_END();
+}
@@ -0,0 +1,152 @@
+/*
+ * Linear speed profile accuracy host test: the ProfileAccuracy sweep, with its step
+ * intervals and move times checked against ideal constant acceleration kinematics,
+ * with the default approximation and with exact ramps.
+ *
+ * Copyright (C)2026 Laurentiu Badea
+ *
+ * This file may be redistributed under the terms of the MIT license.
+ * A copy of this license has been included with this distribution in the file LICENSE.
+ */
+#include <Arduino.h>
+#include <unity.h>
+#include "BasicStepperDriver.h"
+
+#define MOTOR_STEPS 200
+const float RPMS[] = {60, 300, 1200};
+const short MICROSTEPS[] = {1, 16};
+const short ACCELS[][2] = {{200, 200}, {1000, 3000}, {5000, 1000}};
+// move lengths in full steps
+const long MOVES[] = {20, 500};
+// shorter intervals are dominated by the 1us timing resolution
+#define MIN_INTERVAL 100e-6
+
+#define COUNT(array) (sizeof(array)/sizeof(*array))
+
+BasicStepperDriver stepper(MOTOR_STEPS, 12, 13);
+
+void setUp(void){
+    sim_reset();
+}
+
+void tearDown(void){}
+
+/*
+ * Ideal time (s) at which a move of <distance> microsteps reaches <position>,
+ * starting and ending at rest. Speeds in microsteps/s, accelerations in microsteps/s^2.
+ */
+float idealTime(float position, float distance, float speed, float accel, float decel){
+    float accel_distance = speed * speed / (2 * accel);
+    float decel_distance = speed * speed / (2 * decel);
+    if (accel_distance + decel_distance > distance){
+        // triangular move, never reaches the target speed
+        speed = sqrt(2 * distance / (1/accel + 1/decel));
+        accel_distance = speed * speed / (2 * accel);
+        decel_distance = distance - accel_distance;
+    }
+    if (position <= accel_distance){
+        return sqrt(2 * position / accel);
+    }
+    float cruise_end = distance - decel_distance;
+    if (position <= cruise_end){
+        return speed / accel + (position - accel_distance) / speed;
+    }
+    float cruise_time = speed / accel + (cruise_end - accel_distance) / speed;
+    float end_speed2 = speed * speed - 2 * decel * (position - cruise_end);
+    return cruise_time + (speed - sqrt((end_speed2 > 0) ? end_speed2 : 0)) / decel;
+}
+
+/*
+ * Worst errors over the sweep, relative to the ideal values
+ */
+struct Accuracy {
+    float interval;     // step interval of MIN_INTERVAL or more, moves reaching cruise
+    float short_move;   // same, moves too short to reach cruise speed
+    float time;         // total move time from the step intervals
+    float estimate;     // getTimeForMove()
+};
+
+void worse(float& worst, float error){
+    if (fabs(error) > fabs(worst)){
+        worst = error;
+    }
+}
+
+void testProfile(Accuracy& accuracy, bool exact, float rpm, short microsteps,
+                 short accel, short decel, long full_steps){
+    long steps = full_steps * microsteps;
+    stepper.begin(rpm, microsteps);
+    stepper.setSpeedProfile(stepper.LINEAR_SPEED, accel, decel);
+    stepper.setExactRamps(exact);
+    float speed = rpm * MOTOR_STEPS / 60 * microsteps;
+    float a = (float)accel * microsteps;
+    float d = (float)decel * microsteps;
+    float ideal_total = idealTime(steps, steps, speed, a, d);
+    bool cruise = speed * speed / (2 * a) + speed * speed / (2 * d) <= steps;
+    long estimate = stepper.getTimeForMove(steps);
+
+    stepper.startMove(steps);
+    float time = 0;
+    for (long i = 0; i < steps; i++){
+        float interval = stepper.nextProfileStep() / 1e+6;
+        float ideal = idealTime(i + 1, steps, speed, a, d) - idealTime(i, steps, speed, a, d);
+        if (ideal >= MIN_INTERVAL){
+            worse(cruise ? accuracy.interval : accuracy.short_move, (interval - ideal) / ideal);
+        }
+        time += interval;
+    }
+    TEST_ASSERT_EQUAL(0, stepper.nextProfileStep());
+    worse(accuracy.time, (time - ideal_total) / ideal_total);
+    worse(accuracy.estimate, (estimate / 1e+6 - ideal_total) / ideal_total);
+}
+
+Accuracy testSweep(bool exact){
+    Accuracy accuracy = {0, 0, 0, 0};
+    for (unsigned r = 0; r < COUNT(RPMS); r++){
+        for (unsigned m = 0; m < COUNT(MICROSTEPS); m++){
+            for (unsigned a = 0; a < COUNT(ACCELS); a++){
+                for (unsigned s = 0; s < COUNT(MOVES); s++){
+                    testProfile(accuracy, exact, RPMS[r], MICROSTEPS[m],
+                                ACCELS[a][0], ACCELS[a][1], MOVES[s]);
+                }
+            }
+        }
+    }
+    printf("%s: interval_err=%.2f%% short_move=%.2f%% time_err=%.2f%% estimate_err=%.2f%%\n",
+           exact ? "exact ramps" : "default", accuracy.interval * 100,
+           accuracy.short_move * 100, accuracy.time * 100, accuracy.estimate * 100);
+    return accuracy;
+}
+
+/*
+ * The approximation shortens the first step of every move by 32% (a few other steps
+ * by up to 33%), which makes short moves up to 9% faster than planned;
+ * getTimeForMove() plans from the ideal kinematics
+ */
+void test_default_ramps(void){
+    Accuracy accuracy = testSweep(false);
+    TEST_ASSERT_FLOAT_WITHIN(0.34, 0, accuracy.interval);
+    TEST_ASSERT_FLOAT_WITHIN(0.34, 0, accuracy.short_move);
+    TEST_ASSERT_FLOAT_WITHIN(0.09, 0, accuracy.time);
+    TEST_ASSERT_FLOAT_WITHIN(0.001, 0, accuracy.estimate);
+}
+
+/*
+ * With the exact ramp tables, moves that reach cruise speed stay within 2% on every
+ * step. In short moves the steps around the speed peak deviate more, as the
+ * acceleration and deceleration ramps meet between two steps.
+ */
+void test_exact_ramps(void){
+    Accuracy accuracy = testSweep(true);
+    TEST_ASSERT_FLOAT_WITHIN(0.02, 0, accuracy.interval);
+    TEST_ASSERT_FLOAT_WITHIN(0.18, 0, accuracy.short_move);
+    TEST_ASSERT_FLOAT_WITHIN(0.012, 0, accuracy.time);
+    TEST_ASSERT_FLOAT_WITHIN(0.001, 0, accuracy.estimate);
+}
+
+int main(void){
+    UNITY_BEGIN();
+    RUN_TEST(test_default_ramps);
+    RUN_TEST(test_exact_ramps);
+    return UNITY_END();
+}
@@ -0,0 +1,92 @@
+/*
+ * Multi-segment move planning host test: the step pulse series across segments
+ *
+ * Copyright (C)2026 Laurentiu Badea
+ *
+ * This file may be redistributed under the terms of the MIT license.
+ * A copy of this license has been included with this distribution in the file LICENSE.
+ */
+#include <Arduino.h>
+#include <unity.h>
+#include <vector>
+#include "BasicStepperDriver.h"
+
+#define MOTOR_STEPS 200
+
+BasicStepperDriver stepper(MOTOR_STEPS, 2, 3);
+
+void setUp(void){
+    sim_reset();
+    stepper.begin(60, 1);
+    stepper.setPosition(0);
+}
+
+void tearDown(void){}
+
+// run the move and return the step pulse after each step
+std::vector<long> pulses(BasicStepperDriver::Segment* segments, short count){
+    std::vector<long> result;
+    stepper.startMove(segments, count);
+    while (stepper.getStepsRemaining() > 0){
+        stepper.nextAction();
+        result.push_back(stepper.getStatus().step_pulse);
+    }
+    return result;
+}
+
+/*
+ * Largest change between successive pulses (relative), away from the stops at the ends
+ */
+float maxChange(const std::vector<long>& pulses, size_t skip){
+    float worst = 0;
+    for (size_t i = skip + 1; i + skip < pulses.size(); i++){
+        float change = fabs((float)pulses[i] / pulses[i-1] - 1);
+        worst = (change > worst) ? change : worst;
+    }
+    return worst;
+}
+
+/*
+ * A segment too short to slow down within it lowers the speed before it
+ */
+void test_short_segment_slowdown(void){
+    BasicStepperDriver::Segment job[] = {{3000, 300, 1000}, {5, 150, 1000}, {500, 30, 1000}};
+    std::vector<long> series = pulses(job, 3);
+    TEST_ASSERT_EQUAL(3505, series.size());
+    TEST_ASSERT_EQUAL(3505, stepper.getPosition());
+    // the 5 steps at 150rpm slow down from 141 full steps/s (7071us) to 30rpm (10000us)
+    TEST_ASSERT_INT_WITHIN(300, 7071, series[2999]);
+    TEST_ASSERT_INT_WITHIN(300, 10000, series[3004]);
+    TEST_ASSERT_FLOAT_WITHIN(0.1, 0, maxChange(series, 10));
+}
+
+/*
+ * A segment too short to speed up within it is left at the speed it reached
+ */
+void test_short_segment_speedup(void){
+    BasicStepperDriver::Segment job[] = {{500, 30, 1000}, {5, 150, 1000}, {3000, 300, 1000}};
+    std::vector<long> series = pulses(job, 3);
+    TEST_ASSERT_EQUAL(3505, series.size());
+    TEST_ASSERT_FLOAT_WITHIN(0.1, 0, maxChange(series, 10));
+}
+
+/*
+ * Segments with room for their ramps keep their planned speeds
+ */
+void test_speeds_kept(void){
+    BasicStepperDriver::Segment job[] = {{2000, 300, 1000}, {1000, 60, 1000}, {-2000, 120, 1000}};
+    std::vector<long> series = pulses(job, 3);
+    TEST_ASSERT_EQUAL(5000, series.size());
+    TEST_ASSERT_EQUAL(1000, stepper.getPosition());
+    TEST_ASSERT_INT_WITHIN(2, 1000, series[1000]);  // 300rpm
+    TEST_ASSERT_INT_WITHIN(2, 5000, series[2500]);  // 60rpm
+    TEST_ASSERT_INT_WITHIN(2, 2500, series[4000]);  // 120rpm
+}
+
+int main(void){
+    UNITY_BEGIN();
+    RUN_TEST(test_short_segment_slowdown);
+    RUN_TEST(test_short_segment_speedup);
+    RUN_TEST(test_speeds_kept);
+    return UNITY_END();
+}
@@ -0,0 +1,195 @@
+/*
+ * StepRecorder host test: recorded traces against the STEP edges seen on the pins,
+ * including long pauses (gap events) and a full buffer (lost events)
+ *
+ * Copyright (C)2026 Laurentiu Badea
+ *
+ * This file may be redistributed under the terms of the MIT license.
+ * A copy of this license has been included with this distribution in the file LICENSE.
+ */
+#include <Arduino.h>
+#include <unity.h>
+#include <string>
+#include "BasicStepperDriver.h"
+#include "MultiDriver.h"
+#include "StepRecorder.h"
+
+#define MOTOR_STEPS 200
+#define MAX_EDGES 1000
+
+const short DIR_PINS[2] = {2, 4};
+const short STEP_PINS[2] = {3, 5};
+
+BasicStepperDriver m1(MOTOR_STEPS, DIR_PINS[0], STEP_PINS[0]);
+BasicStepperDriver m2(MOTOR_STEPS, DIR_PINS[1], STEP_PINS[1]);
+
+/*
+ * STEP rising edges: time, motor, DIR level
+ */
+struct Edge {
+    unsigned long time;
+    short motor;
+    short dir;
+};
+Edge edges[MAX_EDGES];
+short edge_count;
+
+void recordEdge(int pin, int value){
+    short motor = (pin == STEP_PINS[0]) ? 0 : (pin == STEP_PINS[1]) ? 1 : -1;
+    if (motor < 0 || !value || edge_count == MAX_EDGES){
+        return;
+    }
+    edges[edge_count++] = {sim_now, motor, (short)digitalRead(DIR_PINS[motor])};
+}
+
+/*
+ * print() output, one trace line per entry
+ */
+class TracePrint : public Print {
+public:
+    std::string text;
+    size_t write(uint8_t c){
+        text += (char)c;
+        return 1;
+    }
+};
+
+StepRecorder::Event events[MAX_EDGES];
+
+void setUp(void){
+    sim_reset();
+    m1.begin(120, 1);
+    m2.begin(120, 1);
+    edge_count = 0;
+    sim_write_hook = recordEdge;
+}
+
+void tearDown(void){
+    m1.setRecorder(nullptr);
+    m2.setRecorder(nullptr);
+    sim_write_hook = nullptr;
+}
+
+/*
+ * Compare the events in <recorder> with the edges from <first> on, the first one
+ * timed from the edge before it. Returns the number of steps read.
+ */
+short checkEvents(StepRecorder& recorder, short first){
+    StepRecorder::Event event;
+    unsigned long dt = 0;
+    short i = first;
+    while (recorder.read(event)){
+        dt += event.dt;
+        if (event.flags & STEP_RECORDER_GAP){
+            TEST_ASSERT_EQUAL(0xFFFF, event.dt);
+            continue;
+        }
+        TEST_ASSERT_LESS_THAN(edge_count, i);
+        const Edge& edge = edges[i];
+        TEST_ASSERT_EQUAL((i ? edge.time - edges[i-1].time : 0), dt);
+        TEST_ASSERT_EQUAL(edge.motor, (event.flags & STEP_RECORDER_ID_MASK) >> STEP_RECORDER_ID_SHIFT);
+        TEST_ASSERT_EQUAL(edge.dir, event.flags & STEP_RECORDER_DIR);
+        dt = 0;
+        i++;
+    }
+    return i - first;
+}
+
+/*
+ * Accelerated moves of two motors, forward and back: the printed trace has the
+ * intervals, motors and directions of the steps on the pins
+ */
+void test_trace(void){
+    StepRecorder recorder(events, MAX_EDGES);
+    m1.setSpeedProfile(m1.LINEAR_SPEED, 1000, 1000);
+    m2.setSpeedProfile(m2.LINEAR_SPEED, 500, 2000);
+    m1.setRecorder(&recorder, 0);
+    m2.setRecorder(&recorder, 1);
+    MultiDriver group(m1, m2);
+    group.move(200, -120);
+    group.move(-150, 80);
+    TEST_ASSERT_EQUAL(550, edge_count);
+    TEST_ASSERT_EQUAL(550, recorder.available());
+
+    TracePrint out;
+    TEST_ASSERT_EQUAL(550, recorder.print(out));
+    TEST_ASSERT_EQUAL(0, recorder.available());
+    const char* line = out.text.c_str();
+    for (short i = 0; i < edge_count; i++){
+        unsigned long dt;
+        int motor, dir, length;
+        TEST_ASSERT_EQUAL(3, sscanf(line, "%lu %d %d\n%n", &dt, &motor, &dir, &length));
+        TEST_ASSERT_EQUAL((i ? edges[i].time - edges[i-1].time : 0), dt);
+        TEST_ASSERT_EQUAL(edges[i].motor, motor);
+        TEST_ASSERT_EQUAL(edges[i].dir, dir);
+        line += length;
+    }
+    TEST_ASSERT_EQUAL(0, *line);
+}
+
+/*
+ * Pauses over 65535us are split into gap events, and print() adds them back up
+ */
+void test_gap(void){
+    StepRecorder recorder(events, MAX_EDGES);
+    m1.setRecorder(&recorder);
+    const unsigned long PAUSES[3] = {1000, 0x10000, 200000};
+    m1.step(1);
+    for (short i = 0; i < 3; i++){
+        delayMicroseconds(PAUSES[i]);
+        m1.step(-1);
+    }
+    TEST_ASSERT_EQUAL(4, edge_count);
+    // one gap for 0x10000, three for 200000
+    TEST_ASSERT_EQUAL(4 + 1 + 3, recorder.available());
+    TEST_ASSERT_EQUAL(4, checkEvents(recorder, 0));
+
+    for (short i = 0; i < 3; i++){
+        delayMicroseconds(PAUSES[i]);
+        m1.step(1);
+    }
+    TracePrint out;
+    TEST_ASSERT_EQUAL(3, recorder.print(out));
+    char expected[64];
+    snprintf(expected, sizeof(expected), "%lu 0 1\n%lu 0 1\n%lu 0 1\n",
+             edges[4].time - edges[3].time, edges[5].time - edges[4].time,
+             edges[6].time - edges[5].time);
+    TEST_ASSERT_EQUAL_STRING(expected, out.text.c_str());
+}
+
+/*
+ * A full buffer drops steps and counts them; print() reports each loss once, and
+ * the steps recorded after it keep their time from the last (lost) step
+ */
+void test_lost(void){
+    StepRecorder recorder(events, 8);
+    m1.setRecorder(&recorder);
+    m1.move(20);
+    TEST_ASSERT_EQUAL(20, edge_count);
+    TEST_ASSERT_EQUAL(7, recorder.available());
+    TEST_ASSERT_EQUAL(13, recorder.getLost());
+
+    TracePrint out;
+    TEST_ASSERT_EQUAL(7, recorder.print(out));
+    TEST_ASSERT_TRUE(out.text.find("# lost 13\n") != std::string::npos);
+    out.text.clear();
+    TEST_ASSERT_EQUAL(0, recorder.print(out));
+    TEST_ASSERT_EQUAL_STRING("", out.text.c_str());
+    TEST_ASSERT_EQUAL(13, recorder.getLost());
+
+    m1.move(-3);
+    TEST_ASSERT_EQUAL(3, checkEvents(recorder, 20));
+    TEST_ASSERT_EQUAL(13, recorder.getLost());
+
+    recorder.clear();
+    TEST_ASSERT_EQUAL(0, recorder.getLost());
+    TEST_ASSERT_EQUAL(0, recorder.available());
+}
+
+int main(void){
+    UNITY_BEGIN();
+    RUN_TEST(test_trace);
+    RUN_TEST(test_gap);
+    RUN_TEST(test_lost);
+    return UNITY_END();
+}
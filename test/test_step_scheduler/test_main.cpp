@@ -0,0 +1,178 @@
+/*
+ * StepScheduler host test: step timing of 8 and 16 motors on one scheduler
+ *
+ * Every pin write costs PIN_COST µs of simulated time, so the steps of one pass
+ * delay the others like they would on a board. Each motor runs at its own constant
+ * speed (as in the SchedulerTest sketch), and every step is checked against the
+ * motor's ideal schedule from its first step.
+ *
+ * Copyright (C)2026 Laurentiu Badea
+ *
+ * This file may be redistributed under the terms of the MIT license.
+ * A copy of this license has been included with this distribution in the file LICENSE.
+ */
+#include <Arduino.h>
+#include <unity.h>
+#include "BasicStepperDriver.h"
+#include "MultiDriver.h"
+#include "StepScheduler.h"
+
+#define MOTOR_STEPS 200
+#define MAX_COUNT 16
+#define RPM 300
+// about the cost of digitalWrite() on a 16MHz AVR
+#define PIN_COST 4
+#define STEP_PIN(i) (21 + 2 * (i))
+// a pass over <count> motors: about 2 pin writes per motor, and its clock reads
+#define PASS_TIME(count) ((count) * (2 * PIN_COST + 2))
+#define DIR_PIN(i) (20 + 2 * (i))
+
+BasicStepperDriver* motors[MAX_COUNT];
+
+/*
+ * Step timing check, from the rising edges of the step pins
+ */
+unsigned long first_step[MAX_COUNT];
+long pulse[MAX_COUNT];
+long steps_seen[MAX_COUNT];
+long worst_late;
+
+void recordStep(int pin, int value){
+    sim_now += PIN_COST;
+    if (!value || pin < STEP_PIN(0) || (pin - STEP_PIN(0)) % 2){
+        return;
+    }
+    short i = (pin - STEP_PIN(0)) / 2;
+    if (!steps_seen[i]++){
+        first_step[i] = sim_now;
+        return;
+    }
+    long late = sim_now - (first_step[i] + (steps_seen[i] - 1) * pulse[i]);
+    if (late > worst_late){
+        worst_late = late;
+    }
+}
+
+void setUp(void){
+    sim_write_hook = recordStep;
+    worst_late = 0;
+}
+
+void tearDown(void){
+    sim_write_hook = nullptr;
+}
+
+float motorRPM(short i){
+    return RPM * (1 + i / 4.0);
+}
+
+// set up one second moves, returns the longest expected time
+long setupMoves(short count){
+    long expected = 0;
+    sim_write_hook = nullptr;
+    for (short i = 0; i < count; i++){
+        motors[i]->begin(motorRPM(i), 1);
+        pulse[i] = STEP_PULSE(MOTOR_STEPS, 1, motorRPM(i));
+        long time = motors[i]->getTimeForMove(motorRPM(i) * MOTOR_STEPS / 60);
+        expected = (time > expected) ? time : expected;
+        steps_seen[i] = 0;
+    }
+    sim_write_hook = recordStep;
+    return expected;
+}
+
+void checkSteps(short count){
+    for (short i = 0; i < count; i++){
+        TEST_ASSERT_EQUAL(long(motorRPM(i) * MOTOR_STEPS / 60), steps_seen[i]);
+        TEST_ASSERT_EQUAL(0, motors[i]->getStepsRemaining());
+    }
+}
+
+/*
+ * Runs <count> motors on the scheduler, returns the elapsed time
+ */
+long runScheduler(short count, long expected){
+    StepScheduler scheduler(motors, count);
+    for (short i = 0; i < count; i++){
+        motors[i]->startMove(motorRPM(i) * MOTOR_STEPS / 60);
+    }
+    unsigned long start = micros();
+    unsigned long next;
+    while ((next = scheduler.service(micros()))){
+        BasicStepperDriver::delayMicros(next);
+    }
+    long elapsed = micros() - start;
+    checkSteps(count);
+    printf("scheduler motors=%d expected=%ldus elapsed=%ldus late=%ldus\n",
+           count, expected, elapsed, worst_late);
+    return elapsed;
+}
+
+void test_eight_motors(void){
+    long expected = setupMoves(8);
+    long elapsed = runScheduler(8, expected);
+    TEST_ASSERT_INT_WITHIN(expected / 1000, expected, elapsed);
+    // no later than one pass over all motors
+    TEST_ASSERT_LESS_OR_EQUAL(PASS_TIME(8), worst_late);
+}
+
+void test_sixteen_motors(void){
+    long expected = setupMoves(16);
+    long elapsed = runScheduler(16, expected);
+    TEST_ASSERT_INT_WITHIN(expected / 1000, expected, elapsed);
+    TEST_ASSERT_LESS_OR_EQUAL(PASS_TIME(16), worst_late);
+}
+
+/*
+ * Same speeds: the steps of all motors are due together and fired in one pass,
+ * each motor keeping its own schedule
+ */
+void test_coincident(void){
+    sim_write_hook = nullptr;
+    for (short i = 0; i < 8; i++){
+        motors[i]->begin(RPM, 1);
+        pulse[i] = STEP_PULSE(MOTOR_STEPS, 1, RPM);
+        steps_seen[i] = 0;
+    }
+    sim_write_hook = recordStep;
+    StepScheduler scheduler(motors, 8);
+    for (short i = 0; i < 8; i++){
+        motors[i]->startMove(100);
+    }
+    scheduler.run();
+    for (short i = 0; i < 8; i++){
+        TEST_ASSERT_EQUAL(100, steps_seen[i]);
+    }
+    TEST_ASSERT_LESS_OR_EQUAL(PASS_TIME(8), worst_late);
+    TEST_ASSERT_FALSE(scheduler.isRunning());
+}
+
+/*
+ * The MultiDriver::nextAction() loop on 3 of the motors, for comparison
+ */
+void test_multi_driver(void){
+    long expected = setupMoves(3);
+    MultiDriver controller(*motors[0], *motors[1], *motors[2]);
+    controller.startMove(motorRPM(0) * MOTOR_STEPS / 60, motorRPM(1) * MOTOR_STEPS / 60,
+                         motorRPM(2) * MOTOR_STEPS / 60);
+    unsigned long start = micros();
+    while (controller.nextAction());
+    long elapsed = micros() - start;
+    checkSteps(3);
+    printf("multi     motors=3 expected=%ldus elapsed=%ldus late=%ldus\n",
+           expected, elapsed, worst_late);
+    TEST_ASSERT_INT_WITHIN(expected / 100, expected, elapsed);
+}
+
+int main(void){
+    sim_reset();
+    for (short i = 0; i < MAX_COUNT; i++){
+        motors[i] = new BasicStepperDriver(MOTOR_STEPS, DIR_PIN(i), STEP_PIN(i));
+    }
+    UNITY_BEGIN();
+    RUN_TEST(test_eight_motors);
+    RUN_TEST(test_sixteen_motors);
+    RUN_TEST(test_coincident);
+    RUN_TEST(test_multi_driver);
+    return UNITY_END();
+}
@@ -0,0 +1,190 @@
+/*
+ * StepperTask concurrency test: the stepping task runs on a std::thread while the
+ * test thread queues moves and reads the motors' status snapshots.
+ *
+ * Copyright (C)2026 Laurentiu Badea
+ *
+ * This file may be redistributed under the terms of the MIT license.
+ * A copy of this license has been included with this distribution in the file LICENSE.
+ */
+#include <Arduino.h>
+#include <unity.h>
+#include <chrono>
+#include <thread>
+#include "BasicStepperDriver.h"
+#include "MultiDriver.h"
+#include "StepperTask.h"
+
+#define MOTOR_STEPS 200
+#define MOVES 40
+// give up on a test after this long (real time). The tests stop the task before
+// asserting, since a failed assertion leaves the test function.
+#define TIMEOUT_SECONDS 20
+
+const short STEP_PINS[3] = {3, 5, 7};
+
+BasicStepperDriver m1(MOTOR_STEPS, 2, 3);
+BasicStepperDriver m2(MOTOR_STEPS, 4, 5);
+BasicStepperDriver m3(MOTOR_STEPS, 6, 7);
+BasicStepperDriver* const motors[3] = {&m1, &m2, &m3};
+
+void setUp(void){
+    sim_reset();
+    for (short i = 0; i < 3; i++){
+        motors[i]->setPosition(0);
+    }
+}
+
+void tearDown(void){}
+
+steps_t absSteps(steps_t steps){
+    return (steps < 0) ? -steps : steps;
+}
+
+// all move lengths differ, so a status snapshot can be matched to its move
+steps_t moveSteps(short motor, short move){
+    steps_t steps = 20 + 7 * move + 3 * motor;
+    return (move % 3 == motor) ? -steps : steps;
+}
+
+bool isMoveLength(short motor, short moves, steps_t length){
+    for (short move = 0; move < moves; move++){
+        if (length == absSteps(moveSteps(motor, move))){
+            return true;
+        }
+    }
+    return false;
+}
+
+bool timedOut(std::chrono::steady_clock::time_point start){
+    return std::chrono::steady_clock::now() - start > std::chrono::seconds(TIMEOUT_SECONDS);
+}
+
+/*
+ * Queue moves while they run and check every snapshot read meanwhile
+ */
+void test_queued_moves(void){
+    MultiDriver group(m1, m2, m3);
+    group.begin(600, 1);
+    for (short i = 0; i < 3; i++){
+        motors[i]->setSpeedProfile(BasicStepperDriver::LINEAR_SPEED, 2000, 2000);
+    }
+    StepperTask task(group);
+    TEST_ASSERT_TRUE(task.begin());
+
+    steps_t position[3] = {0, 0, 0};
+    steps_t steps[3] = {0, 0, 0};
+    short queued = 0;
+    long snapshots = 0;
+    long inconsistent = 0;
+    auto start = std::chrono::steady_clock::now();
+    while ((queued < MOVES || task.isRunning()) && !timedOut(start)){
+        if (queued < MOVES && task.startMove(moveSteps(0, queued), moveSteps(1, queued), moveSteps(2, queued))){
+            for (short i = 0; i < 3; i++){
+                position[i] += moveSteps(i, queued);
+                steps[i] += absSteps(moveSteps(i, queued));
+            }
+            queued++;
+        }
+        for (short i = 0; i < 3; i++){
+            BasicStepperDriver::Status status = motors[i]->getStatus();
+            if (status.state == BasicStepperDriver::STOPPED){
+                continue;
+            }
+            snapshots++;
+            steps_t length = status.steps_completed + status.steps_remaining;
+            if (!isMoveLength(i, queued, length)){
+                inconsistent++;
+            }
+            // the ramps are symmetric, so the state must match the half of the move
+            if ((status.state == BasicStepperDriver::ACCELERATING && status.steps_completed > length / 2 + 1) ||
+                (status.state == BasicStepperDriver::DECELERATING && status.steps_remaining > length / 2 + 1)){
+                inconsistent++;
+            }
+        }
+        // the simulated clock only runs when called, so let time pass while the task sleeps
+        delayMicroseconds(20);
+        std::this_thread::yield();
+    }
+    task.end();
+
+    TEST_ASSERT_FALSE(timedOut(start));
+    TEST_ASSERT_GREATER_THAN(0, snapshots);
+    TEST_ASSERT_EQUAL(0, inconsistent);
+    for (short i = 0; i < 3; i++){
+        TEST_ASSERT_EQUAL(position[i], motors[i]->getPosition());
+        TEST_ASSERT_EQUAL(steps[i], sim_edges[STEP_PINS[i]]);
+    }
+}
+
+/*
+ * stop() ends the move in progress and discards the queued ones
+ */
+void test_stop(void){
+    MultiDriver group(m1, m2, m3);
+    group.begin(600, 1);
+    StepperTask task(group);
+    TEST_ASSERT_TRUE(task.begin());
+
+    for (short i = 0; i < 8; i++){
+        TEST_ASSERT_TRUE(task.startMove(1000, 1000, 1000));
+    }
+    auto start = std::chrono::steady_clock::now();
+    BasicStepperDriver::Status status = m1.getStatus();
+    while ((status.state == BasicStepperDriver::STOPPED || status.steps_completed < 100) && !timedOut(start)){
+        delayMicroseconds(20);
+        std::this_thread::yield();
+        status = m1.getStatus();
+    }
+    task.stop();
+    while (task.isRunning() && !timedOut(start)){
+        // the simulated clock only runs when called, so let time pass while the task sleeps
+        delayMicroseconds(20);
+        std::this_thread::yield();
+    }
+    task.end();
+
+    TEST_ASSERT_FALSE(timedOut(start));
+    for (short i = 0; i < 3; i++){
+        TEST_ASSERT_GREATER_THAN(0, motors[i]->getPosition());
+        TEST_ASSERT_LESS_THAN(1000, motors[i]->getPosition());
+        TEST_ASSERT_EQUAL(motors[i]->getPosition(), sim_edges[STEP_PINS[i]]);
+    }
+}
+
+/*
+ * end() leaves no stale stop or queued moves behind, and the task can be restarted
+ */
+void test_restart(void){
+    MultiDriver group(m1, m2, m3);
+    group.begin(600, 1);
+    StepperTask task(group);
+    TEST_ASSERT_TRUE(task.begin());
+    for (short i = 0; i < 4; i++){
+        TEST_ASSERT_TRUE(task.startMove(1000, 1000, 1000));
+    }
+    task.end();
+    TEST_ASSERT_FALSE(task.isRunning());
+
+    steps_t before = m1.getPosition();
+    TEST_ASSERT_TRUE(task.begin());
+    TEST_ASSERT_TRUE(task.startMove(100, 0, 0));
+    auto start = std::chrono::steady_clock::now();
+    while (task.isRunning() && !timedOut(start)){
+        // the simulated clock only runs when called, so let time pass while the task sleeps
+        delayMicroseconds(20);
+        std::this_thread::yield();
+    }
+    task.end();
+
+    TEST_ASSERT_FALSE(timedOut(start));
+    TEST_ASSERT_EQUAL(before + 100, m1.getPosition());
+}
+
+int main(void){
+    UNITY_BEGIN();
+    RUN_TEST(test_queued_moves);
+    RUN_TEST(test_stop);
+    RUN_TEST(test_restart);
+    return UNITY_END();
+}
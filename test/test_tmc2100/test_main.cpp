@@ -0,0 +1,111 @@
+/*
+ * TMC2100 interpolated cruise host test: move timing and synchronization in groups
+ *
+ * Copyright (C)2026 Laurentiu Badea
+ *
+ * This file may be redistributed under the terms of the MIT license.
+ * A copy of this license has been included with this distribution in the file LICENSE.
+ */
+#include <Arduino.h>
+#include <unity.h>
+#include "TMC2100.h"
+#include "SyncDriver.h"
+
+#define MOTOR_STEPS 200
+#define MICROSTEPS 16
+#define CFG1 8
+#define CFG2 9
+
+TMC2100 tmc(MOTOR_STEPS, 2, 3, CFG1, CFG2);
+BasicStepperDriver other(MOTOR_STEPS, 4, 5);
+
+void setUp(void){
+    sim_reset();
+    tmc.begin(300, MICROSTEPS);
+    tmc.setInterpolation(100);
+    other.begin(300, MICROSTEPS);
+    tmc.setPosition(0);
+    other.setPosition(0);
+}
+
+void tearDown(void){}
+
+/*
+ * A constant speed move with a set time keeps its time when cruising interpolated
+ */
+void test_timed_move(void){
+    // 2 revolutions in 1s: 120rpm, above the interpolation speed but below begin()'s
+    unsigned long start = micros();
+    tmc.startMove(2L * MOTOR_STEPS * MICROSTEPS, 1000000L);
+    while (tmc.service(micros()));
+    unsigned long elapsed = micros() - start;
+
+    TEST_ASSERT_EQUAL(2L * MOTOR_STEPS * MICROSTEPS, tmc.getPosition());
+    // most of the move was made with 1/2 step input
+    TEST_ASSERT_LESS_THAN(2L * MOTOR_STEPS * MICROSTEPS / 4, sim_edges[3]);
+    TEST_ASSERT_INT_WITHIN(10000, 1000000L, elapsed);
+}
+
+/*
+ * SyncDriver times its moves through the slower motors' step pulse, the interpolated
+ * one must still arrive with the others
+ */
+void test_sync_group(void){
+    SyncDriver group(tmc, other);
+    unsigned long start = micros();
+    group.startMove(4L * MOTOR_STEPS * MICROSTEPS, 8L * MOTOR_STEPS * MICROSTEPS);
+    unsigned long end[2] = {0, 0};
+    while (group.service(micros())){
+        if (!end[0] && tmc.getCurrentState() == BasicStepperDriver::STOPPED){
+            end[0] = micros();
+        }
+        if (!end[1] && other.getCurrentState() == BasicStepperDriver::STOPPED){
+            end[1] = micros();
+        }
+    }
+    TEST_ASSERT_EQUAL(4L * MOTOR_STEPS * MICROSTEPS, tmc.getPosition());
+    TEST_ASSERT_LESS_THAN(4L * MOTOR_STEPS * MICROSTEPS / 4, sim_edges[3]);
+    TEST_ASSERT_NOT_EQUAL(0, end[0]);
+    TEST_ASSERT_NOT_EQUAL(0, end[1]);
+    // 8 revolutions at 300rpm
+    TEST_ASSERT_INT_WITHIN(20000, 1600000L, end[1] - start);
+    // within 1%, the other motor's step pulse is rounded to whole micros
+    TEST_ASSERT_INT_WITHIN(16000, end[1] - start, end[0] - start);
+}
+
+/*
+ * The calibrated limit is on the STEP rate: an interpolated cruise can go faster
+ * than getMaxRPM() by the interpolation ratio, a normal one cannot.
+ * Runs last, calibrate() limits the motors from then on.
+ */
+void test_calibrated_cruise(void){
+    // a slow board
+    sim_cost = 20;
+    tmc.calibrate();
+    other.calibrate();
+    sim_cost = 1;
+    float max_rpm = tmc.getMaxRPM();
+    TEST_ASSERT_GREATER_THAN(100, max_rpm);
+    TEST_ASSERT_LESS_THAN(300, max_rpm);
+    TEST_ASSERT_FLOAT_WITHIN(1, max_rpm, other.getMaxRPM());
+
+    tmc.setRPM(600);
+    other.setRPM(600);
+    long steps = 4L * MOTOR_STEPS * MICROSTEPS;
+    TEST_ASSERT_INT_WITHIN(1000, steps * STEP_PULSE(MOTOR_STEPS, MICROSTEPS, 600), tmc.getTimeForMove(steps));
+    TEST_ASSERT_INT_WITHIN(1000, steps * STEP_PULSE(MOTOR_STEPS, MICROSTEPS, max_rpm), other.getTimeForMove(steps));
+
+    unsigned long start = micros();
+    tmc.startMove(steps);
+    while (tmc.service(micros()));
+    TEST_ASSERT_EQUAL(steps, tmc.getPosition());
+    TEST_ASSERT_INT_WITHIN(5000, 400000L, micros() - start);
+}
+
+int main(void){
+    UNITY_BEGIN();
+    RUN_TEST(test_timed_move);
+    RUN_TEST(test_sync_group);
+    RUN_TEST(test_calibrated_cruise);
+    return UNITY_END();
+}